@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+typedef struct {
+    uint64_t hash; // 0 = empty slot
+    char* stack; // folded, root first
+    uint64_t bytes;
+    uint64_t count;
+} lean_luau_alloc_site;
+
+struct lean_luau_alloc_profile {
+    size_t sampleBytes;
+    int64_t countdown; // bytes until the next sample
+    int maxDepth;
+    uint8_t running;
+    lean_luau_alloc_site* sites; // open addressing, power of two capacity
+    size_t siteCount;
+    size_t siteCapacity;
+    uint64_t totalBytes; // all allocated bytes seen while running, sampled or not
+    uint64_t pendingSamples; // taken by the allocation hook, attributed at the next safe point
+};
+
+void lean_luau_alloc_profile_free(lean_luau_alloc_profile* profile) {
+    if (profile == NULL) return;
+    for (size_t i = 0; i < profile->siteCapacity; ++i) {
+        free(profile->sites[i].stack);
+    }
+    free(profile->sites);
+    free(profile);
+}
+
+static uint64_t lean_luau_alloc_hash(const char* s, size_t len) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h = (h ^ (uint8_t)s[i]) * 0x100000001b3ULL;
+    }
+    return h == 0 ? 1 : h;
+}
+
+static lean_luau_alloc_site* lean_luau_alloc_find(lean_luau_alloc_site* sites, size_t capacity, uint64_t hash, const char* stack) {
+    size_t i = hash & (capacity - 1);
+    while (sites[i].hash != 0 && (sites[i].hash != hash || strcmp(sites[i].stack, stack) != 0)) {
+        i = (i + 1) & (capacity - 1);
+    }
+    return &sites[i];
+}
+
+static int lean_luau_alloc_grow(lean_luau_alloc_profile* profile) {
+    size_t capacity = profile->siteCapacity == 0 ? 64 : profile->siteCapacity * 2;
+    lean_luau_alloc_site* sites = calloc(capacity, sizeof(lean_luau_alloc_site));
+    if (sites == NULL) return 0;
+    for (size_t i = 0; i < profile->siteCapacity; ++i) {
+        lean_luau_alloc_site* old = &profile->sites[i];
+        if (old->hash != 0) {
+            *lean_luau_alloc_find(sites, capacity, old->hash, old->stack) = *old;
+        }
+    }
+    free(profile->sites);
+    profile->sites = sites;
+    profile->siteCapacity = capacity;
+    return 1;
+}
+
+// Appends a frame label, replacing the separators of the folded format.
+static size_t lean_luau_alloc_append(char* buf, size_t pos, size_t cap, const lua_Debug* ar) {
+    if (pos + 1 >= cap) return pos;
+    if (pos > 0) buf[pos++] = ';';
+    size_t start = pos;
+    int n;
+    if (ar->currentline >= 0) {
+        n = snprintf(buf + pos, cap - pos, "%s %s:%d", ar->name != NULL ? ar->name : "?", ar->short_src, ar->currentline);
+    }
+    else {
+        n = snprintf(buf + pos, cap - pos, "%s %s", ar->name != NULL ? ar->name : "?", ar->short_src);
+    }
+    pos = n < 0 ? pos : (size_t)n >= cap - pos ? cap - 1 : pos + (size_t)n;
+    for (size_t i = start; i < pos; ++i) {
+        if (buf[i] == ';') buf[i] = ':';
+    }
+    return pos;
+}
+
+static void lean_luau_alloc_sample(lua_State* state, lean_luau_alloc_profile* profile, uint64_t samples) {
+    lua_Debug ar;
+    int depth = 0;
+    while (depth < profile->maxDepth && lua_getinfo(state, depth, "sln", &ar)) {
+        ++depth;
+    }
+    char buf[2048];
+    size_t pos = 0;
+    for (int level = depth - 1; level >= 0; --level) {
+        if (lua_getinfo(state, level, "sln", &ar)) {
+            pos = lean_luau_alloc_append(buf, pos, sizeof(buf), &ar);
+        }
+    }
+    if (pos == 0) {
+        memcpy(buf, "[host]", 6);
+        pos = 6;
+    }
+    buf[pos] = '\0';
+    if (2 * (profile->siteCount + 1) > profile->siteCapacity && !lean_luau_alloc_grow(profile)) {
+        return;
+    }
+    uint64_t hash = lean_luau_alloc_hash(buf, pos);
+    lean_luau_alloc_site* site = lean_luau_alloc_find(profile->sites, profile->siteCapacity, hash, buf);
+    if (site->hash == 0) {
+        site->stack = malloc(pos + 1);
+        if (site->stack == NULL) return;
+        memcpy(site->stack, buf, pos + 1);
+        site->hash = hash;
+        ++profile->siteCount;
+    }
+    site->bytes += samples * profile->sampleBytes;
+    site->count += samples;
+}
+
+int lean_luau_alloc_profile_running(const lean_luau_alloc_profile* profile) {
+    return profile != NULL && profile->running;
+}
+
+void lean_luau_alloc_profile_onallocate(lua_State* state, lean_luau_alloc_profile* profile, size_t osize, size_t nsize) {
+    if (!profile->running || nsize <= osize) {
+        return;
+    }
+    size_t grown = nsize - osize;
+    profile->totalBytes += grown;
+    profile->countdown -= (int64_t)grown;
+    if (profile->countdown > 0) {
+        return;
+    }
+    // Every `sampleBytes` bytes are attributed to the allocation crossing the boundary.
+    // The stack can't be walked here: the hook also runs while the stack or the CallInfo array
+    // is being reallocated, before the VM switched to the new block.
+    uint64_t samples = 1 + (uint64_t)(-profile->countdown) / profile->sampleBytes;
+    profile->countdown += (int64_t)(samples * profile->sampleBytes);
+    profile->pendingSamples += samples;
+}
+
+void lean_luau_alloc_profile_flush(lua_State* state, lean_luau_alloc_profile* profile) {
+    if (profile->pendingSamples == 0) {
+        return;
+    }
+    uint64_t samples = profile->pendingSamples;
+    profile->pendingSamples = 0;
+    lean_luau_alloc_sample(state, profile, samples);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_startAllocProfile(lean_luau_State state, size_t sampleBytes, uint32_t maxDepth, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_State_data* main = data->main;
+    if (main->allocProfile == NULL) {
+        main->allocProfile = calloc(1, sizeof(lean_luau_alloc_profile));
+        if (main->allocProfile == NULL) {
+            return lean_luau_ioerr("Out of memory.");
+        }
+    }
+    lean_luau_alloc_profile* profile = main->allocProfile;
+    profile->sampleBytes = sampleBytes > 0 ? sampleBytes : 1;
+    profile->countdown = (int64_t)profile->sampleBytes;
+    profile->maxDepth = (int)maxDepth;
+    profile->running = 1;
+    lean_luau_State_updateCallbacks(main);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_stopAllocProfile(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    if (data->main->allocProfile != NULL) {
+        lean_luau_alloc_profile_flush(data->state, data->main->allocProfile);
+        data->main->allocProfile->running = 0;
+    }
+    lean_luau_State_updateCallbacks(data->main);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_allocProfile(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_alloc_profile* profile = data->main->allocProfile;
+    lean_object* sites = lean_alloc_array(0, profile != NULL ? profile->siteCount : 0);
+    uint64_t totalBytes = 0;
+    if (profile != NULL) {
+        lean_luau_alloc_profile_flush(data->state, profile);
+        totalBytes = profile->totalBytes;
+        for (size_t i = 0; i < profile->siteCapacity; ++i) {
+            lean_luau_alloc_site* site = &profile->sites[i];
+            if (site->hash == 0) continue;
+            // Object fields first, then the scalars in declaration order
+            lean_object* obj = lean_alloc_ctor(0, 1, 2 * sizeof(uint64_t));
+            lean_ctor_set(obj, 0, lean_mk_string(site->stack));
+            lean_ctor_set_uint64(obj, sizeof(void*), site->bytes);
+            lean_ctor_set_uint64(obj, sizeof(void*) + 8, site->count);
+            sites = lean_array_push(sites, obj);
+        }
+    }
+    lean_object* res = lean_alloc_ctor(0, 1, sizeof(uint64_t));
+    lean_ctor_set(res, 0, sites);
+    lean_ctor_set_uint64(res, sizeof(void*), totalBytes);
+    return lean_io_result_mk_ok(res);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_resetAllocProfile(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_alloc_profile* profile = data->main->allocProfile;
+    if (profile != NULL) {
+        for (size_t i = 0; i < profile->siteCapacity; ++i) {
+            free(profile->sites[i].stack);
+        }
+        free(profile->sites);
+        profile->sites = NULL;
+        profile->siteCount = 0;
+        profile->siteCapacity = 0;
+        profile->totalBytes = 0;
+        profile->pendingSamples = 0;
+        profile->countdown = (int64_t)profile->sampleBytes;
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
@@ -0,0 +1,221 @@
+#include <stdlib.h>
+#include <string.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Layout synchronized with `Bundle.write`, integers are little-endian.
+// Header: magic (8), version (u32), chunk count (u32), options fingerprint (u64), index checksum (u64).
+// Index entries, sorted by name: name offset (u32), name length (u32), data offset (u64), data length (u64), data checksum (u64).
+// The index checksum covers the index and the names which follow it.
+#define LEAN_LUAU_BUNDLE_MAGIC "LUAUBNDL"
+#define LEAN_LUAU_BUNDLE_VERSION 1
+#define LEAN_LUAU_BUNDLE_HEADER_SIZE 32
+#define LEAN_LUAU_BUNDLE_ENTRY_SIZE 32
+
+static inline uint32_t lean_luau_Bundle_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t lean_luau_Bundle_u64(const uint8_t* p) {
+    return (uint64_t)lean_luau_Bundle_u32(p) | ((uint64_t)lean_luau_Bundle_u32(p + 4) << 32);
+}
+
+static uint64_t lean_luau_fnv1a(const uint8_t* p, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+void lean_luau_Bundle_unmap(lean_luau_Bundle_data* data) {
+    if (data->base != NULL) {
+#ifdef _WIN32
+        UnmapViewOfFile(data->base);
+        CloseHandle((HANDLE)data->mapping);
+#else
+        munmap((void*)data->base, data->size);
+#endif
+        data->base = NULL;
+    }
+    free(data->verified);
+    data->verified = NULL;
+}
+
+static const char* lean_luau_Bundle_map(const char* path, lean_luau_Bundle_data* data) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return "Can't open the bundle file.";
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return "Can't map the bundle file.";
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) return "Can't map the bundle file.";
+    const void* base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (base == NULL) {
+        CloseHandle(mapping);
+        return "Can't map the bundle file.";
+    }
+    data->base = base;
+    data->size = (size_t)size.QuadPart;
+    data->mapping = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return "Can't open the bundle file.";
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return "Can't map the bundle file.";
+    }
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return "Can't map the bundle file.";
+    data->base = base;
+    data->size = (size_t)st.st_size;
+    data->mapping = NULL;
+#endif
+    return NULL;
+}
+
+static const char* lean_luau_Bundle_validate(lean_luau_Bundle_data* data) {
+    const uint8_t* base = data->base;
+    if (data->size < LEAN_LUAU_BUNDLE_HEADER_SIZE || memcmp(base, LEAN_LUAU_BUNDLE_MAGIC, 8) != 0) {
+        return "Not a bundle file.";
+    }
+    if (lean_luau_Bundle_u32(base + 8) != LEAN_LUAU_BUNDLE_VERSION) {
+        return "Unsupported bundle version.";
+    }
+    uint64_t count = lean_luau_Bundle_u32(base + 12);
+    if (count > (data->size - LEAN_LUAU_BUNDLE_HEADER_SIZE) / LEAN_LUAU_BUNDLE_ENTRY_SIZE) {
+        return "Bundle is truncated.";
+    }
+    size_t indexEnd = LEAN_LUAU_BUNDLE_HEADER_SIZE + count * LEAN_LUAU_BUNDLE_ENTRY_SIZE;
+    size_t namesEnd = indexEnd;
+    for (uint64_t i = 0; i < count; ++i) {
+        const uint8_t* entry = base + LEAN_LUAU_BUNDLE_HEADER_SIZE + i * LEAN_LUAU_BUNDLE_ENTRY_SIZE;
+        uint64_t nameOffset = lean_luau_Bundle_u32(entry);
+        uint64_t nameLen = lean_luau_Bundle_u32(entry + 4);
+        uint64_t dataOffset = lean_luau_Bundle_u64(entry + 8);
+        uint64_t dataLen = lean_luau_Bundle_u64(entry + 16);
+        if (nameOffset < indexEnd || nameOffset + nameLen > data->size || dataOffset > data->size || dataLen > data->size - dataOffset) {
+            return "Bundle is truncated.";
+        }
+        if (nameOffset + nameLen > namesEnd) namesEnd = nameOffset + nameLen;
+    }
+    uint64_t checksum = lean_luau_fnv1a(base + LEAN_LUAU_BUNDLE_HEADER_SIZE, namesEnd - LEAN_LUAU_BUNDLE_HEADER_SIZE);
+    if (checksum != lean_luau_Bundle_u64(base + 24)) {
+        return "Bundle index is corrupted.";
+    }
+    data->count = (uint32_t)count;
+    return NULL;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_Bundle_openFile(b_lean_obj_arg path, lean_obj_arg io_) {
+    lean_luau_Bundle_data* data = lean_pod_alloc(sizeof(lean_luau_Bundle_data));
+    data->base = NULL;
+    data->verified = NULL;
+    data->count = 0;
+    const char* err = lean_luau_Bundle_map(lean_string_cstr(path), data);
+    if (err == NULL) {
+        err = lean_luau_Bundle_validate(data);
+    }
+    if (err == NULL) {
+        data->verified = calloc(data->count > 0 ? data->count : 1, 1);
+    }
+    if (err != NULL) {
+        lean_luau_Bundle_unmap(data);
+        lean_pod_free(data);
+        return lean_luau_ioerr(err);
+    }
+    return lean_io_result_mk_ok(lean_alloc_external(lean_luau_Bundle_class, data));
+}
+
+LEAN_EXPORT uint64_t lean_luau_Bundle_fingerprint(b_lean_obj_arg bundle) {
+    return lean_luau_Bundle_u64(lean_luau_Bundle_fromRepr(bundle)->base + 16);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_Bundle_names(b_lean_obj_arg bundle) {
+    lean_luau_Bundle_data* data = lean_luau_Bundle_fromRepr(bundle);
+    lean_object* names = lean_alloc_array(data->count, data->count);
+    for (uint32_t i = 0; i < data->count; ++i) {
+        const uint8_t* entry = data->base + LEAN_LUAU_BUNDLE_HEADER_SIZE + (size_t)i * LEAN_LUAU_BUNDLE_ENTRY_SIZE;
+        lean_array_set_core(names, i, lean_mk_string_from_bytes(
+            (const char*)data->base + lean_luau_Bundle_u32(entry),
+            lean_luau_Bundle_u32(entry + 4)
+        ));
+    }
+    return names;
+}
+
+// Binary search over the sorted index, returns the entry number or -1.
+static int64_t lean_luau_Bundle_find(lean_luau_Bundle_data* data, const char* name, size_t len) {
+    size_t lo = 0;
+    size_t hi = data->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const uint8_t* entry = data->base + LEAN_LUAU_BUNDLE_HEADER_SIZE + mid * LEAN_LUAU_BUNDLE_ENTRY_SIZE;
+        size_t entryLen = lean_luau_Bundle_u32(entry + 4);
+        int cmp = memcmp(name, data->base + lean_luau_Bundle_u32(entry), len < entryLen ? len : entryLen);
+        if (cmp == 0) cmp = len < entryLen ? -1 : len > entryLen ? 1 : 0;
+        if (cmp == 0) return (int64_t)mid;
+        if (cmp < 0) hi = mid;
+        else lo = mid + 1;
+    }
+    return -1;
+}
+
+LEAN_EXPORT uint8_t lean_luau_Bundle_contains(b_lean_obj_arg bundle, b_lean_obj_arg name) {
+    return lean_luau_Bundle_find(lean_luau_Bundle_fromRepr(bundle), lean_string_cstr(name), lean_string_size(name) - 1) >= 0;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_loadBundled(
+    lean_luau_State state, b_lean_obj_arg bundle, b_lean_obj_arg name,
+    b_lean_obj_arg chunkName, uint32_t env, lean_obj_arg io_
+) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_Bundle_data* bdata = lean_luau_Bundle_fromRepr(bundle);
+    int64_t i = lean_luau_Bundle_find(bdata, lean_string_cstr(name), lean_string_size(name) - 1);
+    if (i < 0) {
+        return lean_luau_ioerr("Chunk not found in the bundle.");
+    }
+    const uint8_t* entry = bdata->base + LEAN_LUAU_BUNDLE_HEADER_SIZE + (size_t)i * LEAN_LUAU_BUNDLE_ENTRY_SIZE;
+    const uint8_t* bytecode = bdata->base + lean_luau_Bundle_u64(entry + 8);
+    size_t size = (size_t)lean_luau_Bundle_u64(entry + 16);
+    if (!bdata->verified[i]) {
+        if (lean_luau_fnv1a(bytecode, size) != lean_luau_Bundle_u64(entry + 24)) {
+            return lean_luau_ioerr("Bundled chunk is corrupted.");
+        }
+        bdata->verified[i] = 1;
+    }
+    return lean_io_result_mk_ok(lean_box(0 != luau_load(
+        data->state,
+        lean_string_cstr(chunkName),
+        (const char*)bytecode,
+        size,
+        (int32_t)env
+    )));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_copyBytes(b_lean_obj_arg size, lean_pod_BytesView view) {
+    size_t size_c = lean_usize_of_nat(size);
+    lean_object* res = lean_alloc_sarray(1, size_c, size_c);
+    memcpy(lean_sarray_cptr(res), lean_pod_BytesView_fromRepr(view)->ptr, size_c);
+    return res;
+}
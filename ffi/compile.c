@@ -59,3 +59,43 @@ LEAN_EXPORT lean_obj_res lean_luau_compile(b_lean_obj_arg source, lean_luau_Comp
         lean_pod_Buffer_box(data, free)
     ));
 }
+
+LEAN_EXPORT lean_obj_res lean_luau_compileChecked(b_lean_obj_arg source, lean_luau_CompileOptions options) {
+    size_t size;
+    char* data = luau_compile(
+        lean_string_cstr(source),
+        lean_string_size(source) - 1,
+        &lean_luau_CompileOptions_fromRepr(options)->options,
+        &size
+    );
+    if (size == 0 || data[0] != 0) {
+        lean_object* ok = lean_alloc_ctor(1, 1, 0);
+        lean_ctor_set(ok, 0, lean_mk_tuple2(lean_usize_to_nat(size), lean_pod_Buffer_box(data, free)));
+        return lean_io_result_mk_ok(ok);
+    }
+    // The error is encoded as a zero byte followed by ":<line>: <message>"
+    const char* msg = data + 1;
+    const char* end = data + size;
+    size_t line = 0;
+    if (msg < end && *msg == ':') {
+        const char* p = msg + 1;
+        while (p < end && *p >= '0' && *p <= '9') {
+            line = line * 10 + (size_t)(*p - '0');
+            ++p;
+        }
+        if (p > msg + 1 && p < end && *p == ':') {
+            msg = p + 1;
+            if (msg < end && *msg == ' ') ++msg;
+        }
+        else {
+            line = 0;
+        }
+    }
+    lean_object* err = lean_alloc_ctor(0, 2, 0);
+    lean_ctor_set(err, 0, lean_usize_to_nat(line));
+    lean_ctor_set(err, 1, lean_mk_string_from_bytes(msg, end - msg));
+    free(data);
+    lean_object* res = lean_alloc_ctor(0, 1, 0);
+    lean_ctor_set(res, 0, err);
+    return lean_io_result_mk_ok(res);
+}
@@ -4,18 +4,7 @@
 #include <lualib.h>
 #include <luau.lean.h>
 
-typedef struct {
-    lean_object* obj;
-    lean_luau_State_data* main;
-    int tag;
-} lean_luau_userdata_tagged;
-
-typedef struct {
-    lean_object* obj;
-    lean_object* dtor; // May be NULL
-} lean_luau_userdata;
-
-static lean_object* lean_luau_State_box(lua_State* state, lean_luau_State_data* main) {
+lean_object* lean_luau_State_box(lua_State* state, lean_luau_State_data* main) {
     lean_luau_State_data* data = lean_pod_alloc(sizeof(lean_luau_State_data));
     data->state = state;
     if (main == NULL) {
@@ -24,16 +13,31 @@ static lean_object* lean_luau_State_box(lua_State* state, lean_luau_State_data*
         for (size_t i = 0; i < LUA_UTAG_LIMIT; ++i) {
             data->taggedUserdataDtors[i] = NULL;
         }
+        data->userdataQueues = calloc(LUA_UTAG_LIMIT + 1, sizeof(lean_luau_userdata_queue));
+        data->podTags = calloc(LUA_UTAG_LIMIT, sizeof(uint8_t));
+        data->proxyTags = calloc(LUA_UTAG_LIMIT, sizeof(uint8_t));
     }
     else {
         data->main = main;
         data->taggedUserdataDtors = NULL;
+        data->userdataQueues = NULL;
+        data->podTags = NULL;
+        data->proxyTags = NULL;
     }
     data->referenced = NULL;
     data->referencedCount = 0;
     data->referencedCapacity = 0;
     data->interruptCallback = NULL;
     data->panicCallback = NULL;
+    data->allocProfile = NULL;
+    data->threadAccounting.enabled = 0;
+    data->threadAccounting.interrupts = 0;
+    data->threadAccounting.last = 0.0;
+    data->threadAccounting.current = NULL;
+    data->pendingError = NULL;
+    data->pendingIOError = NULL;
+    data->externalBytes = 0;
+    data->externalDebt = 0;
     return lean_alloc_external(lean_luau_State_class, (void*)data);
 }
 
@@ -47,15 +51,10 @@ static inline void lean_luau_State_reference(lean_luau_State_data* data, lean_ob
     main->referenced[main->referencedCount++] = obj;
 }
 
-static lean_object* lean_luau_ioerr(const char* errMsg) {
+lean_object* lean_luau_ioerr(const char* errMsg) {
     return lean_io_result_mk_error(lean_mk_io_user_error(lean_mk_string(errMsg)));
 }
 
-#define lean_luau_guard_valid(data)\
-    if ((data)->state == NULL || (data)->main->main == NULL) {\
-        return lean_luau_ioerr("State is invalid (was closed).");\
-    }
-
 
 // Constants
 
@@ -103,6 +102,7 @@ LEAN_EXPORT lean_obj_res lean_luau_State_close(b_lean_obj_arg state, lean_obj_ar
     if (data != data->main) {
         return lean_luau_ioerr("Expected main state.");
     }
+    lean_luau_thread_accounting_close(data);
     lua_close(data->state);
     data->state = NULL;
     data->main = NULL;
@@ -119,6 +119,21 @@ LEAN_EXPORT lean_obj_res lean_luau_State_close(b_lean_obj_arg state, lean_obj_ar
         }
     }
     free(data->taggedUserdataDtors);
+    for (size_t i = 0; i <= LUA_UTAG_LIMIT; ++i) {
+        lean_luau_userdata_queue* queue = &data->userdataQueues[i];
+        for (size_t j = 0; j < queue->count; ++j) {
+            lean_dec(queue->objs[j]);
+        }
+        free(queue->objs);
+    }
+    free(data->userdataQueues);
+    free(data->podTags);
+    data->podTags = NULL;
+    free(data->proxyTags);
+    data->proxyTags = NULL;
+    lean_luau_alloc_profile_free(data->allocProfile);
+    data->allocProfile = NULL;
+    lean_luau_pending_error_clear(data);
     return lean_io_result_mk_ok(lean_box(0));
 }
 
@@ -146,6 +161,16 @@ LEAN_EXPORT lean_obj_res lean_luau_State_resetThread(lean_luau_State state, lean
     return lean_io_result_mk_ok(lean_box(0));
 }
 
+LEAN_EXPORT lean_obj_res lean_luau_State_recycleThread(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    if (data == data->main) {
+        return lean_luau_ioerr("Expected non-main state.");
+    }
+    lua_resetthread(data->state);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
 LEAN_EXPORT lean_obj_res lean_luau_State_isThreadReset(lean_luau_State state, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
@@ -467,6 +492,17 @@ LEAN_EXPORT lean_obj_res lean_luau_State_toCFunction(lean_luau_State state, uint
     return lean_io_result_mk_ok(lean_mk_option_some(obj));
 }
 
+static int lean_luau_CFunction_c(lua_State* state);
+
+LEAN_EXPORT lean_obj_res lean_luau_State_toRawCFunction(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_CFunction fn = lua_tocfunction(data->state, (int32_t)idx);
+    // Lean closures all share the trampoline, its address says nothing about the function
+    if (fn == NULL || fn == lean_luau_CFunction_c) return lean_io_result_mk_ok(lean_mk_option_none());
+    return lean_io_result_mk_ok(lean_mk_option_some(lean_box_usize((size_t)fn)));
+}
+
 // TODO: lean_luau_State_toLightUserdata (Untagged light userdata = light userdata with tag=0)
 
 LEAN_EXPORT lean_obj_res lean_luau_State_toLightUserdataTagged(lean_luau_State state, uint32_t idx, uint32_t tag, lean_obj_arg io_) {
@@ -495,6 +531,9 @@ LEAN_EXPORT lean_obj_res lean_luau_State_toUserdata(lean_luau_State state, uint3
 LEAN_EXPORT lean_obj_res lean_luau_State_toUserdataTagged(lean_luau_State state, uint32_t idx, uint32_t tag, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
+    if (data->main->proxyTags[tag]) {
+        return lean_luau_ioerr("Tag is used by proxies.");
+    }
     lean_luau_userdata_tagged* userdata = lua_touserdatatagged(data->state, (int32_t)idx, tag);
     if (userdata == NULL) {
         return lean_io_result_mk_ok(lean_mk_option_none());
@@ -604,8 +643,23 @@ LEAN_EXPORT lean_obj_res lean_luau_State_pushLightUserdataTagged(lean_luau_State
 
 // TODO: lean_luau_State_pushLightUserdata (Untagged light userdata = light userdata with tag=0)
 
-static void lean_luau_userdata_tagged_dtor(lua_State* state, void* userdata) {
+static void lean_luau_userdata_queue_push(lean_luau_userdata_queue* queue, lean_object* obj) {
+    if (queue->count >= queue->capacity) {
+        size_t newCapacity = queue->capacity == 0 ? 64 : (queue->capacity * 2);
+        queue->objs = realloc(queue->objs, newCapacity * sizeof(lean_object*));
+        queue->capacity = newCapacity;
+    }
+    queue->objs[queue->count++] = obj;
+}
+
+void lean_luau_userdata_tagged_dtor(lua_State* state, void* userdata) {
     lean_luau_userdata_tagged* userdata_ = userdata;
+    userdata_->main->externalBytes -= userdata_->externalSize;
+    lean_luau_userdata_queue* queue = &userdata_->main->userdataQueues[userdata_->tag];
+    if (queue->enabled) {
+        lean_luau_userdata_queue_push(queue, userdata_->obj);
+        return;
+    }
     lean_object* dtor = userdata_->main->taggedUserdataDtors[userdata_->tag];
     if (dtor != NULL) {
         lean_inc_ref(dtor);
@@ -616,35 +670,65 @@ static void lean_luau_userdata_tagged_dtor(lua_State* state, void* userdata) {
     lean_dec(userdata_->obj);
 }
 
-static void lean_luau_userdata_dtor(void* userdata) {
+void lean_luau_userdata_dtor(void* userdata) {
     lean_luau_userdata* userdata_ = userdata;
+    userdata_->main->externalBytes -= userdata_->externalSize;
     if (userdata_->dtor != NULL) {
         lean_object* res = lean_apply_2(userdata_->dtor, userdata_->obj, lean_box(0));
         lean_dec_ref(res);
         return;
     }
+    lean_luau_userdata_queue* queue = &userdata_->main->userdataQueues[LUA_UTAG_LIMIT];
+    if (queue->enabled) {
+        lean_luau_userdata_queue_push(queue, userdata_->obj);
+        return;
+    }
     lean_dec(userdata_->obj);
 }
 
 LEAN_EXPORT lean_obj_res lean_luau_State_newUserdataTagged(lean_luau_State state, lean_obj_arg userdata, uint32_t tag, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
-    lean_luau_guard_valid(data);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec(userdata);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    if (data->main->podTags[tag]) {
+        lean_dec(userdata);
+        return lean_luau_ioerr("Tag is used by plain-data userdata.");
+    }
+    if (data->main->proxyTags[tag]) {
+        lean_dec(userdata);
+        return lean_luau_ioerr("Tag is used by proxies.");
+    }
     lean_luau_userdata_tagged* dst = lua_newuserdatatagged(data->state, sizeof(lean_luau_userdata_tagged), tag);
     lua_setuserdatadtor(data->state, tag, lean_luau_userdata_tagged_dtor);
     dst->obj = userdata;
     dst->tag = tag;
     dst->main = data->main;
+    dst->externalSize = 0;
     return lean_io_result_mk_ok(lean_box(0));
 }
 
 LEAN_EXPORT lean_obj_res lean_luau_State_newUserdataTaggedWithMetatable(lean_luau_State state, lean_obj_arg userdata, uint32_t tag, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
-    lean_luau_guard_valid(data);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec(userdata);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    if (data->main->podTags[tag]) {
+        lean_dec(userdata);
+        return lean_luau_ioerr("Tag is used by plain-data userdata.");
+    }
+    if (data->main->proxyTags[tag]) {
+        lean_dec(userdata);
+        return lean_luau_ioerr("Tag is used by proxies.");
+    }
     lean_luau_userdata_tagged* dst = lua_newuserdatataggedwithmetatable(data->state, sizeof(lean_luau_userdata_tagged), tag);
     lua_setuserdatadtor(data->state, tag, lean_luau_userdata_tagged_dtor);
     dst->obj = userdata;
     dst->tag = tag;
     dst->main = data->main;
+    dst->externalSize = 0;
     return lean_io_result_mk_ok(lean_box(0));
 }
 
@@ -654,6 +738,8 @@ LEAN_EXPORT lean_obj_res lean_luau_State_newUserdata(lean_luau_State state, lean
     lean_luau_userdata* dst = lua_newuserdatadtor(data->state, sizeof(lean_luau_userdata), lean_luau_userdata_dtor);
     dst->obj = userdata;
     dst->dtor = NULL;
+    dst->main = data->main;
+    dst->externalSize = 0;
     return lean_io_result_mk_ok(lean_box(0));
 }
 
@@ -663,9 +749,56 @@ LEAN_EXPORT lean_obj_res lean_luau_State_newUserdataDtor(lean_luau_State state,
     lean_luau_userdata* dst = lua_newuserdatadtor(data->state, sizeof(lean_luau_userdata), lean_luau_userdata_dtor);
     dst->obj = userdata;
     dst->dtor = dtor;
+    dst->main = data->main;
+    dst->externalSize = 0;
     return lean_io_result_mk_ok(lean_box(0));
 }
 
+// Returns the size field of the Lean-backed userdata at `idx`, or NULL.
+static size_t* lean_luau_userdata_externalSize(lua_State* state, int idx) {
+    if (lua_type(state, idx) != LUA_TUSERDATA) {
+        return NULL;
+    }
+    int tag = lua_userdatatag(state, idx);
+    if (tag < LUA_UTAG_LIMIT) {
+        if (lua_getuserdatadtor(state, tag) != lean_luau_userdata_tagged_dtor) {
+            return NULL;
+        }
+        return &((lean_luau_userdata_tagged*)lua_touserdata(state, idx))->externalSize;
+    }
+    lean_luau_userdata* ud = lean_luau_userdata_to(state, idx);
+    return ud != NULL ? &ud->externalSize : NULL;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_setExternalSize(lean_luau_State state, uint32_t idx, size_t size, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    size_t* externalSize = lean_luau_userdata_externalSize(data->state, (int32_t)idx);
+    if (externalSize == NULL) {
+        return lean_luau_ioerr("Expected Lean-backed userdata.");
+    }
+    lean_luau_State_data* main = data->main;
+    size_t old = *externalSize;
+    *externalSize = size;
+    main->externalBytes = main->externalBytes - old + size;
+    if (size > old) {
+        // Pay for the growth with GC work, as if Luau had allocated it
+        main->externalDebt += size - old;
+        size_t kb = main->externalDebt >> 10;
+        if (kb > 0) {
+            main->externalDebt &= 1023;
+            lua_gc(data->state, LUA_GCSTEP, kb > INT32_MAX ? INT32_MAX : (int)kb);
+        }
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_externalBytes(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    return lean_io_result_mk_ok(lean_box_usize(data->main->externalBytes));
+}
+
 LEAN_EXPORT lean_obj_res lean_luau_State_newBuffer(lean_luau_State state, b_lean_obj_arg sz, lean_pod_BytesView src, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
@@ -675,10 +808,172 @@ LEAN_EXPORT lean_obj_res lean_luau_State_newBuffer(lean_luau_State state, b_lean
     return lean_io_result_mk_ok(lean_box(0));
 }
 
+LEAN_EXPORT lean_obj_res lean_luau_State_newUserdataPod(lean_luau_State state, uint32_t tag, b_lean_obj_arg sz, lean_pod_BytesView src, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    if (lua_getuserdatadtor(data->state, tag) == lean_luau_userdata_tagged_dtor) {
+        return lean_luau_ioerr("Tag is used by Lean-backed userdata.");
+    }
+    data->main->podTags[tag] = 1;
+    size_t size = lean_usize_of_nat(sz);
+    void* dst = lua_newuserdatatagged(data->state, size, tag);
+    memcpy(dst, lean_pod_BytesView_fromRepr(src)->ptr, size);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_newUserdataPodWithMetatable(lean_luau_State state, uint32_t tag, b_lean_obj_arg sz, lean_pod_BytesView src, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    if (lua_getuserdatadtor(data->state, tag) == lean_luau_userdata_tagged_dtor) {
+        return lean_luau_ioerr("Tag is used by Lean-backed userdata.");
+    }
+    data->main->podTags[tag] = 1;
+    size_t size = lean_usize_of_nat(sz);
+    void* dst = lua_newuserdatataggedwithmetatable(data->state, size, tag);
+    memcpy(dst, lean_pod_BytesView_fromRepr(src)->ptr, size);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+// Returns a pointer to `width` bytes at `offset` inside of the plain-data userdata, NULL if out of bounds or not matching.
+static void* lean_luau_State_podField(lua_State* state, int idx, int tag, size_t offset, size_t width) {
+    void* ud = lua_touserdatatagged(state, idx, tag);
+    if (ud == NULL) return NULL;
+    size_t len = lua_objlen(state, idx);
+    if (offset > len || width > len - offset) return NULL;
+    return (char*)ud + offset;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_toUserdataPod(lean_luau_State state, uint32_t idx, uint32_t tag, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* ud = lua_touserdatatagged(data->state, (int32_t)idx, tag);
+    if (ud == NULL) {
+        return lean_io_result_mk_ok(lean_mk_option_none());
+    }
+    size_t len = lua_objlen(data->state, (int32_t)idx);
+    lean_object* ba = lean_alloc_sarray(1, len, len);
+    memcpy(lean_sarray_cptr(ba), ud, len);
+    return lean_io_result_mk_ok(lean_mk_option_some(ba));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podGetUInt8(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    uint8_t* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint8_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    return lean_io_result_mk_ok(lean_box(*field));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podGetUInt16(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint16_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    uint16_t val;
+    memcpy(&val, field, sizeof(uint16_t));
+    return lean_io_result_mk_ok(lean_box(val));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podGetUInt32(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint32_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    uint32_t val;
+    memcpy(&val, field, sizeof(uint32_t));
+    return lean_io_result_mk_ok(lean_box_uint32(val));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podGetUInt64(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint64_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    uint64_t val;
+    memcpy(&val, field, sizeof(uint64_t));
+    return lean_io_result_mk_ok(lean_box_uint64(val));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podGetFloat(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(double));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    double val;
+    memcpy(&val, field, sizeof(double));
+    return lean_io_result_mk_ok(lean_box_float(val));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podSetUInt8(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, uint8_t val, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    uint8_t* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint8_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    *field = val;
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podSetUInt16(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, uint16_t val, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint16_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    memcpy(field, &val, sizeof(uint16_t));
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podSetUInt32(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, uint32_t val, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint32_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    memcpy(field, &val, sizeof(uint32_t));
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podSetUInt64(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, uint64_t val, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(uint64_t));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    memcpy(field, &val, sizeof(uint64_t));
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_podSetFloat(lean_luau_State state, uint32_t idx, uint32_t tag, size_t offset, double val, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    void* field = lean_luau_State_podField(data->state, (int32_t)idx, tag, offset, sizeof(double));
+    if (field == NULL) {
+        return lean_luau_ioerr("Invalid plain-data userdata field access.");
+    }
+    memcpy(field, &val, sizeof(double));
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
 typedef struct {
     lean_object* fn;
     lean_object* cont; // May be NULL
     lean_luau_State_data* main;
+    lean_luau_fn_stats* stats; // NULL unless instrumented
 } lean_luau_CFunction_data;
 
 static void lean_luau_CFunction_data_dtor(void* userdata) {
@@ -690,20 +985,16 @@ static void lean_luau_CFunction_data_dtor(void* userdata) {
     free(userdata_);
 }
 
-lean_object* lean_io_error_to_string(lean_object* err);
-
 static int lean_luau_CFunction_c(lua_State* state) {
     lean_luau_CFunction_data* ud = lua_touserdata(state, lua_upvalueindex(1));
+    int frame = lean_luau_instrumentation_enter(ud->stats, &ud);
     lean_inc_ref(ud->fn);
     lean_obj_res res = lean_apply_2(ud->fn, lean_luau_State_box(state, ud->main), lean_box(0));
+    if (frame >= 0) {
+        lean_luau_instrumentation_leave(frame, lean_io_result_is_error(res));
+    }
     if (lean_io_result_is_error(res)) {
-        lean_object* err = lean_io_result_get_error(res);
-        lean_inc(err);
-        lean_object* errs = lean_io_error_to_string(err);
-        lua_pushstring(state, lean_string_cstr(errs));
-        lean_dec_ref(errs);
-        lean_dec_ref(res);
-        lua_error(state);
+        lean_luau_raise_io_error(state, ud->main, res);
     }
     int nresults = (int32_t)lean_unbox_uint32(lean_io_result_get_value(res));
     lean_dec_ref(res);
@@ -715,13 +1006,7 @@ static int lean_luau_Continuation_c(lua_State* state, int status) {
     lean_inc_ref(ud->cont);
     lean_obj_res res = lean_apply_3(ud->cont, lean_luau_State_box(state, ud->main), lean_box(status), lean_box(0));
     if (lean_io_result_is_error(res)) {
-        lean_object* err = lean_io_result_get_error(res);
-        lean_inc(err);
-        lean_object* errs = lean_io_error_to_string(err);
-        lua_pushstring(state, lean_string_cstr(errs));
-        lean_dec_ref(errs);
-        lean_dec_ref(res);
-        lua_error(state);
+        lean_luau_raise_io_error(state, ud->main, res);
     }
     int nresults = (int32_t)lean_unbox_uint32(lean_io_result_get_value(res));
     lean_dec_ref(res);
@@ -737,6 +1022,7 @@ LEAN_EXPORT lean_obj_res lean_luau_State_pushCClosureK(lean_luau_State state, le
     ud->main = data->main;
     lua_insert(data->state, lua_gettop(data->state) - nup);
     const char* debugName_c = lean_option_is_some(debugName) ? lean_string_cstr(lean_ctor_get(debugName, 0)) : NULL;
+    ud->stats = lean_luau_instrumentation_lookup(debugName_c);
     lua_pushcclosurek(data->state, lean_luau_CFunction_c, debugName_c, nup + 1, lean_luau_Continuation_c);
     return lean_io_result_mk_ok(lean_box(0));
 }
@@ -747,6 +1033,7 @@ static void lean_luau_State_pushCClosure_impl(lua_State* state, lean_luau_State_
     ud->fn = fn;
     ud->cont = NULL;
     ud->main = main;
+    ud->stats = lean_luau_instrumentation_lookup(debugName);
     lua_insert(state, lua_gettop(state) - nup);
     lua_pushcclosure(state, lean_luau_CFunction_c, debugName, nup + 1);
 }
@@ -759,6 +1046,14 @@ LEAN_EXPORT lean_obj_res lean_luau_State_pushCClosure(lean_luau_State state, lea
     return lean_io_result_mk_ok(lean_box(0));
 }
 
+LEAN_EXPORT lean_obj_res lean_luau_State_pushRawCClosure(lean_luau_State state, size_t fn, b_lean_obj_arg debugName, uint32_t nup, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    const char* debugName_c = lean_option_is_some(debugName) ? lean_string_cstr(lean_ctor_get(debugName, 0)) : NULL;
+    lua_pushcclosure(data->state, (lua_CFunction)fn, debugName_c, nup);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
 
 // Get functions
 
@@ -911,9 +1206,11 @@ LEAN_EXPORT lean_obj_res lean_luau_State_call(lean_luau_State state, uint32_t nA
 LEAN_EXPORT lean_obj_res lean_luau_State_pcall(lean_luau_State state, uint32_t nArgs, uint32_t nResults, uint32_t errFunc, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
-    return lean_io_result_mk_ok(lean_box_uint32((int32_t)
-        lua_pcall(data->state, (int32_t)nArgs, (int32_t)nResults, (int32_t)errFunc)
-    ));
+    int status = lua_pcall(data->state, (int32_t)nArgs, (int32_t)nResults, (int32_t)errFunc);
+    if (status != LUA_OK) {
+        lean_luau_instrumentation_settle(&data);
+    }
+    return lean_io_result_mk_ok(lean_box_uint32((int32_t)status));
 }
 
 
@@ -942,9 +1239,20 @@ LEAN_EXPORT lean_obj_res lean_luau_State_resume(lean_luau_State state, lean_luau
         lean_luau_guard_valid(from_data);
         from_c = from_data->state;
     }
-    return lean_io_result_mk_ok(lean_box(
-        lua_resume(data->state, from_c, (int32_t)narg)
-    ));
+    lean_luau_thread_accounting* acc = &data->main->threadAccounting;
+    if (!acc->enabled) {
+        return lean_io_result_mk_ok(lean_box(
+            lua_resume(data->state, from_c, (int32_t)narg)
+        ));
+    }
+    lean_luau_thread_stats* stats = lean_luau_thread_stats_of(data->state);
+    if (stats != NULL) {
+        ++stats->resumes;
+    }
+    lean_luau_thread_accounting_checkpoint(data->main, stats);
+    int status = lua_resume(data->state, from_c, (int32_t)narg);
+    lean_luau_thread_accounting_checkpoint(data->main, from_c != NULL ? lean_luau_thread_stats_of(from_c) : NULL);
+    return lean_io_result_mk_ok(lean_box(status));
 }
 
 LEAN_EXPORT lean_obj_res lean_luau_State_resumeError(lean_luau_State state, lean_luau_State from, lean_obj_arg io_) {
@@ -956,7 +1264,18 @@ LEAN_EXPORT lean_obj_res lean_luau_State_resumeError(lean_luau_State state, lean
         lean_luau_guard_valid(from_data);
         from_c = from_data->state;
     }
-    return lean_io_result_mk_ok(lean_box(lua_resumeerror(data->state, from_c)));
+    lean_luau_thread_accounting* acc = &data->main->threadAccounting;
+    if (!acc->enabled) {
+        return lean_io_result_mk_ok(lean_box(lua_resumeerror(data->state, from_c)));
+    }
+    lean_luau_thread_stats* stats = lean_luau_thread_stats_of(data->state);
+    if (stats != NULL) {
+        ++stats->resumes;
+    }
+    lean_luau_thread_accounting_checkpoint(data->main, stats);
+    int status = lua_resumeerror(data->state, from_c);
+    lean_luau_thread_accounting_checkpoint(data->main, from_c != NULL ? lean_luau_thread_stats_of(from_c) : NULL);
+    return lean_io_result_mk_ok(lean_box(status));
 }
 
 LEAN_EXPORT lean_obj_res lean_luau_State_status(lean_luau_State state, lean_obj_arg io_) {
@@ -1043,6 +1362,10 @@ LEAN_EXPORT lean_obj_res lean_luau_State_clock(lean_luau_State state, lean_obj_a
 LEAN_EXPORT lean_obj_res lean_luau_State_setUserdataDtor(lean_luau_State state, uint32_t tag, lean_obj_arg dtor, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
+    if (data->main->proxyTags[tag]) {
+        lean_dec_ref(dtor);
+        return lean_luau_ioerr("Tag is used by proxies.");
+    }
     lean_object** dtors = data->main->taggedUserdataDtors;
     if (dtors[tag] != NULL) {
         lean_dec_ref(dtors[tag]);
@@ -1062,6 +1385,42 @@ LEAN_EXPORT lean_obj_res lean_luau_State_resetUserdataDtor(lean_luau_State state
     return lean_io_result_mk_ok(lean_box(0));
 }
 
+static lean_object* lean_luau_userdata_queue_drain(lean_luau_userdata_queue* queue) {
+    lean_object* arr = lean_alloc_array(queue->count, queue->count);
+    memcpy(lean_array_cptr(arr), queue->objs, queue->count * sizeof(lean_object*));
+    queue->count = 0;
+    return arr;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_setUserdataQueued(lean_luau_State state, uint32_t tag, uint8_t enabled, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    if (data->main->proxyTags[tag]) {
+        return lean_luau_ioerr("Tag is used by proxies.");
+    }
+    data->main->userdataQueues[tag].enabled = enabled;
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_setUntaggedUserdataQueued(lean_luau_State state, uint8_t enabled, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    data->main->userdataQueues[LUA_UTAG_LIMIT].enabled = enabled;
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_drainUserdataQueue(lean_luau_State state, uint32_t tag, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    return lean_io_result_mk_ok(lean_luau_userdata_queue_drain(&data->main->userdataQueues[tag]));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_drainUntaggedUserdataQueue(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    return lean_io_result_mk_ok(lean_luau_userdata_queue_drain(&data->main->userdataQueues[LUA_UTAG_LIMIT]));
+}
+
 LEAN_EXPORT lean_obj_res lean_luau_State_setUserdataMetatable(lean_luau_State state, uint32_t tag, uint32_t idx, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
@@ -1131,6 +1490,12 @@ LEAN_EXPORT lean_obj_res lean_luau_State_unref(lean_luau_State state, uint32_t r
 
 static void lean_luau_interrupt_callback(lua_State* state, int gc) {
     lean_luau_State_data* data = lean_luau_State_unbox(lua_callbacks(state)->userdata);
+    if (gc < 0 && data->main != NULL && data->threadAccounting.enabled && (++data->threadAccounting.interrupts & 63) == 0) {
+        lean_luau_thread_accounting_checkpoint(data, lean_luau_thread_stats_of(state));
+    }
+    if (gc < 0 && data->main != NULL && data->allocProfile != NULL) {
+        lean_luau_alloc_profile_flush(state, data->allocProfile);
+    }
     if (data->main == NULL || data->main->main == NULL || data->main->interruptCallback == NULL) {
         return;
     }
@@ -1161,10 +1526,35 @@ LEAN_EXPORT lean_obj_res lean_luau_State_resetInterruptCallback(lean_luau_State
         lean_dec_ref(data->interruptCallback);
         data->interruptCallback = NULL;
     }
-    lua_callbacks(data->state)->interrupt = NULL;
+    // Accounting and the allocation profiler still need interrupts
+    lean_luau_State_updateCallbacks(data->main);
     return lean_io_result_mk_ok(lean_box(0));
 }
 
+static void lean_luau_onallocate(lua_State* state, size_t osize, size_t nsize) {
+    lean_luau_State_data* data = lean_luau_State_unbox(lua_callbacks(state)->userdata);
+    if (data->threadAccounting.enabled) {
+        lean_luau_thread_stats_onallocate(state, osize, nsize);
+    }
+    if (data->allocProfile != NULL) {
+        lean_luau_alloc_profile_onallocate(state, data->allocProfile, osize, nsize);
+    }
+}
+
+void lean_luau_State_updateCallbacks(lean_luau_State_data* main) {
+    lua_Callbacks* cb = lua_callbacks(main->state);
+    int accounting = main->threadAccounting.enabled;
+    int profiling = lean_luau_alloc_profile_running(main->allocProfile);
+    cb->onallocate = accounting || profiling ? lean_luau_onallocate : NULL;
+    // Allocation samples are attributed at VM interrupts
+    if (accounting || profiling) {
+        cb->interrupt = lean_luau_interrupt_callback;
+    }
+    else if (main->interruptCallback == NULL) {
+        cb->interrupt = NULL;
+    }
+}
+
 static void lean_luau_panic_callback(lua_State* state, int errcode) {
     lean_luau_State_data* data = lean_luau_State_unbox(lua_callbacks(state)->userdata);
     if (data->main == NULL || data->main->main == NULL || data->main->panicCallback == NULL) {
@@ -1204,24 +1594,28 @@ LEAN_EXPORT lean_obj_res lean_luau_State_resetPanicCallback(lean_luau_State stat
 
 // luaL_*
 
-LEAN_EXPORT lean_obj_res lean_luau_State_register(lean_luau_State state, b_lean_obj_arg libname, b_lean_obj_arg funcs, lean_obj_arg io_) {
-    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
-    lean_luau_guard_valid(data);
-    const char* libname_c = lean_string_cstr(libname);
-    size_t size = lean_array_size(funcs);
+// Pushes the library table, creating it like `luaL_register` does.
+static void lean_luau_State_pushLib(lua_State* state, const char* libname, size_t size) {
     // check whether lib already exists
-    luaL_findtable(data->state, LUA_REGISTRYINDEX, "_LOADED", 1);
-    lua_getfield(data->state, -1, libname_c); // get _LOADED[libname_c]
-    if (!lua_istable(data->state, -1))
+    luaL_findtable(state, LUA_REGISTRYINDEX, "_LOADED", 1);
+    lua_getfield(state, -1, libname); // get _LOADED[libname]
+    if (!lua_istable(state, -1))
     {                  // not found?
-        lua_pop(data->state, 1); // remove previous result
+        lua_pop(state, 1); // remove previous result
         // try global variable (and create one if it does not exist)
-        if (luaL_findtable(data->state, LUA_GLOBALSINDEX, libname_c, size) != NULL)
-            luaL_error(data->state, "name conflict for module '%s'", libname_c);
-        lua_pushvalue(data->state, -1);
-        lua_setfield(data->state, -3, libname_c); // _LOADED[libname_c] = new table
+        if (luaL_findtable(state, LUA_GLOBALSINDEX, libname, size) != NULL)
+            luaL_error(state, "name conflict for module '%s'", libname);
+        lua_pushvalue(state, -1);
+        lua_setfield(state, -3, libname); // _LOADED[libname] = new table
     }
-    lua_remove(data->state, -2);
+    lua_remove(state, -2);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_register(lean_luau_State state, b_lean_obj_arg libname, b_lean_obj_arg funcs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    size_t size = lean_array_size(funcs);
+    lean_luau_State_pushLib(data->state, lean_string_cstr(libname), size);
     for (size_t i = 0; i < size; ++i) {
         lean_object* pair = lean_array_get_core(funcs, i);
         const char* name = lean_string_cstr(lean_ctor_get(pair, 0));
@@ -1233,6 +1627,20 @@ LEAN_EXPORT lean_obj_res lean_luau_State_register(lean_luau_State state, b_lean_
     return lean_io_result_mk_ok(lean_box(0));
 }
 
+LEAN_EXPORT lean_obj_res lean_luau_State_registerRaw(lean_luau_State state, b_lean_obj_arg libname, b_lean_obj_arg funcs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    size_t size = lean_array_size(funcs);
+    lean_luau_State_pushLib(data->state, lean_string_cstr(libname), size);
+    for (size_t i = 0; i < size; ++i) {
+        lean_object* pair = lean_array_get_core(funcs, i);
+        const char* name = lean_string_cstr(lean_ctor_get(pair, 0));
+        lua_pushcfunction(data->state, (lua_CFunction)lean_unbox_usize(lean_ctor_get(pair, 1)), name);
+        lua_setfield(data->state, -2, name);
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
 LEAN_EXPORT lean_obj_res lean_luau_State_getMetaField(lean_luau_State state, uint32_t obj, b_lean_obj_arg event, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
@@ -1414,6 +1822,109 @@ LEAN_EXPORT lean_obj_res lean_luau_State_typeNameL(lean_luau_State state, uint32
     return lean_io_result_mk_ok(lean_mk_string(luaL_typename(data->state, (int32_t)idx)));
 }
 
+static lean_object* lean_luau_StrBuf_new(b_lean_obj_arg state) {
+    lean_luau_StrBuf_data* buf = lean_pod_alloc(sizeof(lean_luau_StrBuf_data));
+    lean_inc_ref(state);
+    buf->state = state;
+    buf->finished = 0;
+    return lean_alloc_external(lean_luau_StrBuf_class, buf);
+}
+
+#define lean_luau_StrBuf_guard(buf)\
+    lean_luau_guard_valid(lean_luau_State_unbox((buf)->state));\
+    if ((buf)->finished) {\
+        return lean_luau_ioerr("String buffer is finished.");\
+    }
+
+LEAN_EXPORT lean_obj_res lean_luau_State_bufInit(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_object* obj = lean_luau_StrBuf_new(state);
+    luaL_buffinit(data->state, &lean_luau_StrBuf_unbox(obj)->buf);
+    return lean_io_result_mk_ok(obj);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_bufInitSize(lean_luau_State state, size_t size, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_object* obj = lean_luau_StrBuf_new(state);
+    luaL_buffinitsize(data->state, &lean_luau_StrBuf_unbox(obj)->buf, size);
+    return lean_io_result_mk_ok(obj);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_StrBuf_addString(lean_luau_StrBuf buf, b_lean_obj_arg s, lean_obj_arg io_) {
+    lean_luau_StrBuf_data* data = lean_luau_StrBuf_fromRepr(buf);
+    lean_luau_StrBuf_guard(data);
+    luaL_addlstring(&data->buf, lean_string_cstr(s), lean_string_size(s) - 1);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_StrBuf_addChar(lean_luau_StrBuf buf, uint32_t c, lean_obj_arg io_) {
+    lean_luau_StrBuf_data* data = lean_luau_StrBuf_fromRepr(buf);
+    lean_luau_StrBuf_guard(data);
+    char utf8[4];
+    size_t len;
+    if (c < 0x80) {
+        utf8[0] = (char)c;
+        len = 1;
+    }
+    else if (c < 0x800) {
+        utf8[0] = (char)(0xC0 | (c >> 6));
+        utf8[1] = (char)(0x80 | (c & 0x3F));
+        len = 2;
+    }
+    else if (c < 0x10000) {
+        utf8[0] = (char)(0xE0 | (c >> 12));
+        utf8[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (c & 0x3F));
+        len = 3;
+    }
+    else {
+        utf8[0] = (char)(0xF0 | (c >> 18));
+        utf8[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (c & 0x3F));
+        len = 4;
+    }
+    luaL_addlstring(&data->buf, utf8, len);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_StrBuf_addValue(lean_luau_StrBuf buf, lean_obj_arg io_) {
+    lean_luau_StrBuf_data* data = lean_luau_StrBuf_fromRepr(buf);
+    lean_luau_StrBuf_guard(data);
+    luaL_addvalue(&data->buf);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_StrBuf_pushResult(lean_luau_StrBuf buf, lean_obj_arg io_) {
+    lean_luau_StrBuf_data* data = lean_luau_StrBuf_fromRepr(buf);
+    lean_luau_StrBuf_guard(data);
+    luaL_pushresult(&data->buf);
+    data->finished = 1;
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_pushStringFromChunks(lean_luau_State state, b_lean_obj_arg chunks, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    size_t count = lean_array_size(chunks);
+    size_t size = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size += lean_string_size(lean_array_get_core(chunks, i)) - 1;
+    }
+    luaL_Strbuf buf;
+    char* dst = luaL_buffinitsize(data->state, &buf, size);
+    for (size_t i = 0; i < count; ++i) {
+        lean_object* chunk = lean_array_get_core(chunks, i);
+        size_t chunkSize = lean_string_size(chunk) - 1;
+        memcpy(dst, lean_string_cstr(chunk), chunkSize);
+        dst += chunkSize;
+    }
+    luaL_pushresultsize(&buf, size);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
 LEAN_EXPORT lean_obj_res lean_luau_State_openBase(lean_luau_State state, lean_obj_arg io_) {
     lean_luau_State_data* data = lean_luau_State_fromRepr(state);
     lean_luau_guard_valid(data);
@@ -0,0 +1,189 @@
+#include <string.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+#define LEAN_LUAU_HOST_ERROR_METATABLE "_LEAN_HOST_ERROR"
+
+// HostError fields: payload, message (thunk), then the code
+#define LEAN_LUAU_HOST_ERROR_PAYLOAD 0
+#define LEAN_LUAU_HOST_ERROR_MESSAGE 1
+#define LEAN_LUAU_HOST_ERROR_CODE (2 * sizeof(void*))
+
+// CallError constructors
+#define LEAN_LUAU_CALL_ERROR_HOST 0
+#define LEAN_LUAU_CALL_ERROR_SCRIPT 1
+
+lean_object* lean_io_error_to_string(lean_object* err);
+
+void lean_luau_pending_error_clear(lean_luau_State_data* main) {
+    if (main->pendingError != NULL) {
+        lean_dec(main->pendingError);
+        lean_dec(main->pendingIOError);
+        main->pendingError = NULL;
+        main->pendingIOError = NULL;
+    }
+}
+
+static void lean_luau_HostError_dtor(void* userdata) {
+    lean_dec(*(lean_object**)userdata);
+}
+
+b_lean_obj_arg lean_luau_HostError_to(lua_State* state, int idx) {
+    if (lua_type(state, idx) != LUA_TUSERDATA || !lua_getmetatable(state, idx)) {
+        return NULL;
+    }
+    lua_getfield(state, LUA_REGISTRYINDEX, LEAN_LUAU_HOST_ERROR_METATABLE);
+    int matches = lua_rawequal(state, -1, -2);
+    lua_pop(state, 2);
+    return matches ? *(lean_object**)lua_touserdata(state, idx) : NULL;
+}
+
+static b_lean_obj_arg lean_luau_HostError_check(lua_State* state, int idx) {
+    b_lean_obj_arg err = lean_luau_HostError_to(state, idx);
+    if (err == NULL) {
+        luaL_typeerrorL(state, idx, "HostError");
+    }
+    return err;
+}
+
+// The message is only formatted when a script asks for it
+static void lean_luau_HostError_pushMessage(lua_State* state, b_lean_obj_arg err) {
+    b_lean_obj_arg msg = lean_thunk_get(lean_ctor_get(err, LEAN_LUAU_HOST_ERROR_MESSAGE));
+    lua_pushlstring(state, lean_string_cstr(msg), lean_string_size(msg) - 1);
+}
+
+static int lean_luau_HostError_index(lua_State* state) {
+    b_lean_obj_arg err = lean_luau_HostError_check(state, 1);
+    const char* key = lua_tostring(state, 2);
+    if (key == NULL) {
+        lua_pushnil(state);
+    }
+    else if (strcmp(key, "code") == 0) {
+        lua_pushnumber(state, lean_ctor_get_uint32(err, LEAN_LUAU_HOST_ERROR_CODE));
+    }
+    else if (strcmp(key, "payload") == 0) {
+        lean_luau_Value_push(state, lean_ctor_get(err, LEAN_LUAU_HOST_ERROR_PAYLOAD));
+    }
+    else if (strcmp(key, "message") == 0) {
+        lean_luau_HostError_pushMessage(state, err);
+    }
+    else {
+        lua_pushnil(state);
+    }
+    return 1;
+}
+
+static int lean_luau_HostError_tostring(lua_State* state) {
+    lean_luau_HostError_pushMessage(state, lean_luau_HostError_check(state, 1));
+    return 1;
+}
+
+void lean_luau_HostError_push(lua_State* state, lean_obj_arg err) {
+    // The userdata may end up in a state running on another thread
+    lean_mark_mt(err);
+    lean_object** ud = lua_newuserdatadtor(state, sizeof(lean_object*), lean_luau_HostError_dtor);
+    *ud = err;
+    if (luaL_newmetatable(state, LEAN_LUAU_HOST_ERROR_METATABLE)) {
+        lua_pushcfunction(state, lean_luau_HostError_index, "__index");
+        lua_setfield(state, -2, "__index");
+        lua_pushcfunction(state, lean_luau_HostError_tostring, "__tostring");
+        lua_setfield(state, -2, "__tostring");
+        lua_pushstring(state, "HostError");
+        lua_setfield(state, -2, "__type");
+        lua_pushstring(state, "locked");
+        lua_setfield(state, -2, "__metatable");
+    }
+    lua_setmetatable(state, -2);
+}
+
+void lean_luau_raise_io_error(lua_State* state, lean_luau_State_data* main, lean_obj_arg res) {
+    lean_object* err = lean_io_result_get_error(res);
+    if (main->pendingError != NULL && main->pendingIOError == err) {
+        // Raised by `State.throwError`: no message is formatted
+        lean_object* hostError = main->pendingError;
+        lean_dec(main->pendingIOError);
+        main->pendingError = NULL;
+        main->pendingIOError = NULL;
+        lean_dec_ref(res);
+        lean_luau_HostError_push(state, hostError);
+        lua_error(state);
+    }
+    lean_inc(err);
+    lean_object* errs = lean_io_error_to_string(err);
+    lua_pushstring(state, lean_string_cstr(errs));
+    lean_dec_ref(errs);
+    lean_dec_ref(res);
+    lua_error(state);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_hostIOError(lean_luau_State state, lean_obj_arg err, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec(err);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    // Only the last raised error is kept, an earlier one was caught by Lean code
+    lean_luau_pending_error_clear(data->main);
+    lean_object* ioError = lean_mk_io_user_error(lean_mk_string("Luau host error."));
+    lean_inc(ioError);
+    data->main->pendingError = err;
+    data->main->pendingIOError = ioError;
+    return lean_io_result_mk_ok(ioError);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_pushHostError(lean_luau_State state, lean_obj_arg err, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec(err);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    if (!lua_checkstack(data->state, 3)) {
+        lean_dec(err);
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    lean_luau_HostError_push(data->state, err);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_toHostError(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    b_lean_obj_arg err = lean_luau_HostError_to(data->state, (int32_t)idx);
+    if (err == NULL) {
+        return lean_io_result_mk_ok(lean_mk_option_none());
+    }
+    lean_inc(err);
+    return lean_io_result_mk_ok(lean_mk_option_some(err));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_pcallExcept(lean_luau_State state, uint32_t nArgs, uint32_t nResults, uint8_t refs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    int status = lua_pcall(L, (int32_t)nArgs, (int32_t)nResults, 0);
+    if (status == LUA_OK) {
+        lean_object* res = lean_alloc_ctor(1, 1, 0);
+        lean_ctor_set(res, 0, lean_box(0));
+        return lean_io_result_mk_ok(res);
+    }
+    lean_luau_instrumentation_settle(&data);
+    lean_object* callError;
+    b_lean_obj_arg hostError = lean_luau_HostError_to(L, -1);
+    if (hostError != NULL) {
+        lean_inc(hostError);
+        callError = lean_alloc_ctor(LEAN_LUAU_CALL_ERROR_HOST, 1, 0);
+        lean_ctor_set(callError, 0, hostError);
+    }
+    else {
+        callError = lean_alloc_ctor(LEAN_LUAU_CALL_ERROR_SCRIPT, 1, 1);
+        lean_ctor_set(callError, 0, lean_luau_Value_read(L, -1, refs));
+        lean_ctor_set_uint8(callError, sizeof(void*), (uint8_t)status);
+    }
+    lua_pop(L, 1);
+    lean_object* res = lean_alloc_ctor(0, 1, 0);
+    lean_ctor_set(res, 0, callError);
+    return lean_io_result_mk_ok(res);
+}
@@ -0,0 +1,220 @@
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+// Field descriptors (see `FieldKind.code`): kind in the high byte, offset in the low 24 bits.
+// Object fields are addressed by their index, scalar fields by the offset passed to `lean_ctor_get_*`.
+#define LEAN_LUAU_FIELD_KIND(d) ((d) >> 24)
+#define LEAN_LUAU_FIELD_OFFSET(d) ((d) & 0xffffff)
+
+#define LEAN_LUAU_FIELD_STRING 1
+#define LEAN_LUAU_FIELD_NAT 2
+#define LEAN_LUAU_FIELD_VALUE 3
+#define LEAN_LUAU_FIELD_BYTEARRAY 4
+#define LEAN_LUAU_FIELD_BOOL 5
+#define LEAN_LUAU_FIELD_UINT8 6
+#define LEAN_LUAU_FIELD_UINT16 7
+#define LEAN_LUAU_FIELD_UINT32 8
+#define LEAN_LUAU_FIELD_INT32 9
+#define LEAN_LUAU_FIELD_UINT64 10
+#define LEAN_LUAU_FIELD_FLOAT 11
+#define LEAN_LUAU_FIELD_USIZE 12
+
+// Number of `Value` constructors, synchronized with value.c
+#define LEAN_LUAU_VALUE_CTORS 7
+
+static size_t lean_luau_field_width(unsigned kind) {
+    switch (kind) {
+        case LEAN_LUAU_FIELD_BOOL:
+        case LEAN_LUAU_FIELD_UINT8:
+            return 1;
+        case LEAN_LUAU_FIELD_UINT16:
+            return 2;
+        case LEAN_LUAU_FIELD_UINT32:
+        case LEAN_LUAU_FIELD_INT32:
+            return 4;
+        case LEAN_LUAU_FIELD_UINT64:
+        case LEAN_LUAU_FIELD_FLOAT:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+// Whether the boxed field has the representation of its kind.
+static int lean_luau_field_object_valid(b_lean_obj_arg field, unsigned kind) {
+    switch (kind) {
+        case LEAN_LUAU_FIELD_STRING:
+            return !lean_is_scalar(field) && lean_is_string(field);
+        case LEAN_LUAU_FIELD_NAT:
+            return lean_is_scalar(field) || lean_is_mpz(field);
+        case LEAN_LUAU_FIELD_VALUE:
+            return lean_is_scalar(field) || (lean_is_ctor(field) && lean_ptr_tag(field) < LEAN_LUAU_VALUE_CTORS);
+        case LEAN_LUAU_FIELD_BYTEARRAY:
+            return !lean_is_scalar(field) && lean_is_sarray(field) && lean_sarray_elem_size(field) == 1;
+        default:
+            return 0;
+    }
+}
+
+// Whether the descriptor is within the bounds of the constructor object,
+// and boxed fields have the representation of their kind.
+static int lean_luau_field_valid(b_lean_obj_arg obj, uint32_t desc) {
+    if (lean_is_scalar(obj) || !lean_is_ctor(obj)) {
+        return 0;
+    }
+    unsigned kind = LEAN_LUAU_FIELD_KIND(desc);
+    unsigned offset = LEAN_LUAU_FIELD_OFFSET(desc);
+    size_t numObjs = lean_ctor_num_objs(obj);
+    switch (kind) {
+        case LEAN_LUAU_FIELD_STRING:
+        case LEAN_LUAU_FIELD_NAT:
+        case LEAN_LUAU_FIELD_VALUE:
+        case LEAN_LUAU_FIELD_BYTEARRAY:
+            return offset < numObjs && lean_luau_field_object_valid(lean_ctor_get(obj, offset), kind);
+        case LEAN_LUAU_FIELD_USIZE:
+            offset *= sizeof(size_t);
+            // fallthrough
+        default: {
+            size_t width = kind == LEAN_LUAU_FIELD_USIZE ? sizeof(size_t) : lean_luau_field_width(kind);
+            size_t size = lean_object_byte_size(obj) - sizeof(lean_ctor_object);
+            return width > 0 && offset >= numObjs * sizeof(void*) && offset + width <= size;
+        }
+    }
+}
+
+static void lean_luau_field_push(lua_State* state, b_lean_obj_arg obj, uint32_t desc) {
+    unsigned offset = LEAN_LUAU_FIELD_OFFSET(desc);
+    // Guards against layouts that don't match the stored objects
+    if (!lean_luau_field_valid(obj, desc)) {
+        lua_pushnil(state);
+        return;
+    }
+    switch (LEAN_LUAU_FIELD_KIND(desc)) {
+        case LEAN_LUAU_FIELD_STRING: {
+            b_lean_obj_arg s = lean_ctor_get(obj, offset);
+            lua_pushlstring(state, lean_string_cstr(s), lean_string_size(s) - 1);
+            break;
+        }
+        case LEAN_LUAU_FIELD_NAT: {
+            b_lean_obj_arg n = lean_ctor_get(obj, offset);
+            lua_pushnumber(state, lean_is_scalar(n) ? (double)lean_unbox(n) : (double)lean_uint64_of_nat(n));
+            break;
+        }
+        case LEAN_LUAU_FIELD_VALUE:
+            lean_luau_Value_push(state, lean_ctor_get(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_BYTEARRAY: {
+            b_lean_obj_arg bytes = lean_ctor_get(obj, offset);
+            size_t size = lean_sarray_size(bytes);
+            memcpy(lua_newbuffer(state, size), lean_sarray_cptr(bytes), size);
+            break;
+        }
+        case LEAN_LUAU_FIELD_BOOL:
+            lua_pushboolean(state, lean_ctor_get_uint8(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_UINT8:
+            lua_pushnumber(state, lean_ctor_get_uint8(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_UINT16:
+            lua_pushnumber(state, lean_ctor_get_uint16(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_UINT32:
+            lua_pushnumber(state, lean_ctor_get_uint32(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_INT32:
+            lua_pushnumber(state, (int32_t)lean_ctor_get_uint32(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_UINT64:
+            lua_pushnumber(state, (double)lean_ctor_get_uint64(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_FLOAT:
+            lua_pushnumber(state, lean_ctor_get_float(obj, offset));
+            break;
+        case LEAN_LUAU_FIELD_USIZE:
+            lua_pushnumber(state, (double)lean_ctor_get_usize(obj, offset));
+            break;
+        default:
+            lua_pushnil(state);
+    }
+}
+
+// Upvalues: tag, descriptors (name -> descriptor), methods (may be nil)
+static int lean_luau_fields_index(lua_State* state) {
+    int tag = lua_tointeger(state, lua_upvalueindex(1));
+    lean_luau_userdata_tagged* ud = lua_touserdatatagged(state, 1, tag);
+    if (ud == NULL) {
+        luaL_typeerrorL(state, 1, "userdata");
+    }
+    lua_pushvalue(state, 2);
+    lua_rawget(state, lua_upvalueindex(2));
+    if (lua_isnumber(state, -1)) {
+        uint32_t desc = (uint32_t)lua_tonumber(state, -1);
+        lua_pop(state, 1);
+        lean_luau_field_push(state, ud->obj, desc);
+        return 1;
+    }
+    lua_pop(state, 1);
+    if (lua_istable(state, lua_upvalueindex(3))) {
+        lua_pushvalue(state, 2);
+        lua_rawget(state, lua_upvalueindex(3));
+        return 1;
+    }
+    lua_pushnil(state);
+    return 1;
+}
+
+static int lean_luau_fields_newindex(lua_State* state) {
+    luaL_error(state, "attempt to modify a readonly field");
+    return 0;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_registerFieldAccessors(
+    lean_luau_State state, uint32_t tag, b_lean_obj_arg fields, uint32_t methods, lean_obj_arg io_
+) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    if (!lua_checkstack(L, 6)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    int top = lua_gettop(L);
+    int methods_c = (int32_t)methods != 0 ? lua_absindex(L, (int32_t)methods) : 0;
+    lua_getuserdatametatable(L, tag);
+    int taken = !lua_isnil(L, -1);
+    lua_pop(L, 1);
+    if (taken) {
+        return lean_luau_ioerr("Tag already has a metatable.");
+    }
+    lua_Destructor dtor = lua_getuserdatadtor(L, tag);
+    if ((dtor != NULL && dtor != lean_luau_userdata_tagged_dtor) || data->main->podTags[tag]) {
+        return lean_luau_ioerr("Tag is not used by Lean-backed userdata.");
+    }
+    lua_setuserdatadtor(L, tag, lean_luau_userdata_tagged_dtor);
+    size_t n = lean_array_size(fields);
+    lua_newtable(L); // metatable
+    lua_pushinteger(L, (int32_t)tag);
+    lua_createtable(L, 0, (int)n);
+    for (size_t i = 0; i < n; ++i) {
+        b_lean_obj_arg pair = lean_array_get_core(fields, i);
+        b_lean_obj_arg name = lean_ctor_get(pair, 0);
+        lua_pushlstring(L, lean_string_cstr(name), lean_string_size(name) - 1);
+        lua_pushnumber(L, (double)lean_unbox_uint32(lean_ctor_get(pair, 1)));
+        lua_rawset(L, -3);
+    }
+    if (methods_c != 0) {
+        lua_pushvalue(L, methods_c);
+    }
+    else {
+        lua_pushnil(L);
+    }
+    lua_pushcclosure(L, lean_luau_fields_index, "__index", 3);
+    lua_setfield(L, -2, "__index");
+    lua_pushcfunction(L, lean_luau_fields_newindex, "__newindex");
+    lua_setfield(L, -2, "__newindex");
+    lua_setuserdatametatable(L, tag, -1);
+    lua_settop(L, top);
+    return lean_io_result_mk_ok(lean_box(0));
+}
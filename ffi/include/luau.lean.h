@@ -1,6 +1,8 @@
+#include <string.h>
 #include <lean/lean.h>
 #include <lean_pod.h>
 #include <luacode.h>
+#include <lualib.h>
 
 typedef struct {
     lua_CompileOptions options;
@@ -22,16 +24,179 @@ LEAN_POD_DECLARE_EXTERNAL_CLASS(luau_CompileOptions, lean_luau_CompileOptions_da
 typedef struct lua_State lua_State;
 
 typedef struct lean_luau_State_data lean_luau_State_data;
+typedef struct lean_luau_alloc_profile lean_luau_alloc_profile;
+
+// Per-thread counters, stored as the thread data (see `State.setThreadAccounting`).
+typedef struct {
+    uint64_t cpuNanos;
+    uint64_t allocatedBytes;
+    uint64_t allocations;
+    uint64_t resumes;
+} lean_luau_thread_stats;
+
+typedef struct {
+    uint8_t enabled;
+    uint32_t interrupts; // the clock is read every 64 interrupts
+    double last; // time of the last checkpoint
+    lean_luau_thread_stats* current; // charged until the next checkpoint, may be NULL
+} lean_luau_thread_accounting;
+
+// Dead userdata objects waiting to be passed to Lean (see `State.setUserdataQueued`).
+typedef struct {
+    lean_object** objs;
+    size_t count;
+    size_t capacity;
+    uint8_t enabled;
+} lean_luau_userdata_queue;
 
 struct lean_luau_State_data {
     lua_State* state; // NULL = closed
     lean_luau_State_data* main;
     lean_object** taggedUserdataDtors; // undefined for non-main data
+    lean_luau_userdata_queue* userdataQueues; // undefined for non-main data, last one is for untagged userdata
+    uint8_t* podTags; // undefined for non-main data, tags used by plain-data userdata
+    uint8_t* proxyTags; // undefined for non-main data, tags registered with `registerProxyTag`
     lean_object** referenced; // undefined for non-main data
     size_t referencedCount; // undefined for non-main data
     size_t referencedCapacity; // undefined for non-main data
     lean_object* interruptCallback; // undefined for non-main data, may be NULL
     lean_object* panicCallback; // undefined for non-main data, may be NULL
+    lean_luau_alloc_profile* allocProfile; // undefined for non-main data, may be NULL
+    lean_luau_thread_accounting threadAccounting; // undefined for non-main data
+    lean_object* pendingError; // undefined for non-main data, `HostError` raised by `State.throwError`, may be NULL
+    lean_object* pendingIOError; // undefined for non-main data, the `IO.Error` carrying `pendingError`
+    size_t externalBytes; // undefined for non-main data, declared with `State.setExternalSize`
+    size_t externalDebt; // undefined for non-main data, external growth not yet paid for by the GC
 };
 
 LEAN_POD_DECLARE_EXTERNAL_CLASS(luau_State, lean_luau_State_data*)
+
+typedef struct {
+    lean_object* obj;
+    lean_luau_State_data* main;
+    size_t externalSize; // counted in `main->externalBytes`
+    int tag;
+} lean_luau_userdata_tagged;
+
+typedef struct {
+    lean_object* obj;
+    lean_object* dtor; // May be NULL
+    lean_luau_State_data* main;
+    size_t externalSize; // counted in `main->externalBytes`
+} lean_luau_userdata;
+
+// Defined in core.c
+
+lean_object* lean_luau_State_box(lua_State* state, lean_luau_State_data* main);
+lean_object* lean_luau_ioerr(const char* errMsg);
+void lean_luau_userdata_tagged_dtor(lua_State* state, void* userdata);
+void lean_luau_userdata_dtor(void* userdata);
+// Installs the allocation and interrupt callbacks needed by the enabled features.
+void lean_luau_State_updateCallbacks(lean_luau_State_data* main);
+
+// Returns the userdata at `idx` if it was created by `newUserdata`/`newUserdataDtor`, NULL otherwise.
+// `lua_newuserdatadtor` stores the destructor right after the payload, which identifies them.
+static inline lean_luau_userdata* lean_luau_userdata_to(lua_State* state, int idx) {
+    void* ud = lua_touserdatatagged(state, idx, LUA_UTAG_LIMIT);
+    if (ud == NULL || lua_objlen(state, idx) != sizeof(lean_luau_userdata) + sizeof(void (*)(void*))) {
+        return NULL;
+    }
+    void (*dtor)(void*);
+    memcpy(&dtor, (char*)ud + sizeof(lean_luau_userdata), sizeof(dtor));
+    return dtor == lean_luau_userdata_dtor ? ud : NULL;
+}
+
+// Defined in value.c
+
+lean_object* lean_luau_Value_read(lua_State* state, int idx, int refs);
+void lean_luau_Value_push(lua_State* state, b_lean_obj_arg value);
+
+// Makes room for `extra` more bytes in a byte array, reusing it when it is not shared.
+static inline lean_object* lean_luau_ByteArray_reserve(lean_object* arr, size_t extra) {
+    size_t size = lean_sarray_size(arr);
+    if (lean_is_exclusive(arr) && lean_sarray_capacity(arr) - size >= extra) {
+        return arr;
+    }
+    size_t capacity = lean_sarray_capacity(arr) * 2;
+    if (capacity < size + extra) capacity = size + extra;
+    if (capacity < 64) capacity = 64;
+    lean_object* res = lean_alloc_sarray(1, size, capacity);
+    memcpy(lean_sarray_cptr(res), lean_sarray_cptr(arr), size);
+    lean_dec_ref(arr);
+    return res;
+}
+
+// Takes ownership of `arr` and returns an empty byte array reusing its allocation when possible.
+static inline lean_object* lean_luau_ByteArray_clear(lean_object* arr) {
+    if (lean_is_exclusive(arr)) {
+        lean_to_sarray(arr)->m_size = 0;
+        return arr;
+    }
+    lean_dec_ref(arr);
+    return lean_alloc_sarray(1, 0, 64);
+}
+
+#define lean_luau_guard_valid(data)\
+    if ((data)->state == NULL || (data)->main->main == NULL) {\
+        return lean_luau_ioerr("State is invalid (was closed).");\
+    }
+
+typedef struct {
+    luaL_Strbuf buf;
+    lean_object* state; // keeps the state alive
+    uint8_t finished;
+} lean_luau_StrBuf_data;
+
+LEAN_POD_DECLARE_EXTERNAL_CLASS(luau_StrBuf, lean_luau_StrBuf_data*)
+
+typedef struct {
+    const uint8_t* base; // mapped file
+    size_t size;
+    uint32_t count;
+    uint8_t* verified; // per-chunk flags, set once the checksum was checked
+    void* mapping; // platform handle, if any
+} lean_luau_Bundle_data;
+
+LEAN_POD_DECLARE_EXTERNAL_CLASS(luau_Bundle, lean_luau_Bundle_data*)
+
+// Defined in bundle.c
+void lean_luau_Bundle_unmap(lean_luau_Bundle_data* data);
+
+// Defined in instrumentation.c
+
+typedef struct lean_luau_fn_stats lean_luau_fn_stats;
+
+// Returns NULL when instrumentation is disabled.
+lean_luau_fn_stats* lean_luau_instrumentation_lookup(const char* name);
+// `sp` is the address of a local of the caller. Returns a negative value when the call is not measured.
+int lean_luau_instrumentation_enter(lean_luau_fn_stats* stats, const void* sp);
+void lean_luau_instrumentation_leave(int frame, int error);
+// Counts the calls entered below `sp` on the C stack as errors, after a protected call returned.
+void lean_luau_instrumentation_settle(const void* sp);
+
+// Defined in allocprof.c
+
+void lean_luau_alloc_profile_free(lean_luau_alloc_profile* profile);
+int lean_luau_alloc_profile_running(const lean_luau_alloc_profile* profile);
+void lean_luau_alloc_profile_onallocate(lua_State* state, lean_luau_alloc_profile* profile, size_t osize, size_t nsize);
+// Attributes the samples taken since the last flush to the current stack. Only called at safe points.
+void lean_luau_alloc_profile_flush(lua_State* state, lean_luau_alloc_profile* profile);
+
+// Defined in threadstats.c
+
+// Creates the counters on first use, returns NULL if out of memory.
+lean_luau_thread_stats* lean_luau_thread_stats_of(lua_State* state);
+void lean_luau_thread_stats_onallocate(lua_State* state, size_t osize, size_t nsize);
+// Charges the time since the last checkpoint and switches to `next` (may be NULL).
+void lean_luau_thread_accounting_checkpoint(lean_luau_State_data* main, lean_luau_thread_stats* next);
+void lean_luau_thread_accounting_close(lean_luau_State_data* main);
+
+// Defined in errors.c
+
+// Pushes a `HostError` userdata, taking ownership of `err`.
+void lean_luau_HostError_push(lua_State* state, lean_obj_arg err);
+// Returns the `HostError` of the userdata at `idx` (borrowed), or NULL.
+b_lean_obj_arg lean_luau_HostError_to(lua_State* state, int idx);
+// Pushes the error of a failed IO result and raises it. Takes ownership of `res`.
+void lean_luau_raise_io_error(lua_State* state, lean_luau_State_data* main, lean_obj_arg res);
+void lean_luau_pending_error_clear(lean_luau_State_data* main);
@@ -3,6 +3,8 @@
 
 LEAN_POD_DEFINE_EXTERNAL_CLASS(luau_CompileOptions)
 LEAN_POD_DEFINE_EXTERNAL_CLASS(luau_State)
+LEAN_POD_DEFINE_EXTERNAL_CLASS(luau_StrBuf)
+LEAN_POD_DEFINE_EXTERNAL_CLASS(luau_Bundle)
 
 static void lean_luau_CompileOptions_finalize(void* data) {
     lean_luau_CompileOptions_data* data_ = data;
@@ -24,6 +26,7 @@ static void lean_luau_State_finalize(void* data) {
     lean_luau_State_data* data_ = data;
     if (data_->state != NULL) {
         if (data_->main == data_) {
+            lean_luau_thread_accounting_close(data_);
             lua_close(data_->state);
             for (size_t i = 0; i < LUA_UTAG_LIMIT; ++i) {
                 if (data_->taggedUserdataDtors[i] != NULL) {
@@ -31,6 +34,16 @@ static void lean_luau_State_finalize(void* data) {
                 }
             }
             free(data_->taggedUserdataDtors);
+            for (size_t i = 0; i <= LUA_UTAG_LIMIT; ++i) {
+                lean_luau_userdata_queue* queue = &data_->userdataQueues[i];
+                for (size_t j = 0; j < queue->count; ++j) {
+                    lean_dec(queue->objs[j]);
+                }
+                free(queue->objs);
+            }
+            free(data_->userdataQueues);
+            free(data_->podTags);
+            free(data_->proxyTags);
             for (size_t i = 0; i < data_->referencedCount; ++i) {
                 lean_dec(data_->referenced[i]);
             }
@@ -41,6 +54,8 @@ static void lean_luau_State_finalize(void* data) {
             if (data_->panicCallback != NULL) {
                 lean_dec_ref(data_->panicCallback);
             }
+            lean_luau_alloc_profile_free(data_->allocProfile);
+            lean_luau_pending_error_clear(data_);
         }
     }
     lean_pod_free(data_);
@@ -62,6 +77,14 @@ static void lean_luau_State_foreach(void* data, b_lean_obj_arg f) {
                 lean_apply_1(f, data_->taggedUserdataDtors[i]);
             }
         }
+        for (size_t i = 0; i <= LUA_UTAG_LIMIT; ++i) {
+            lean_luau_userdata_queue* queue = &data_->userdataQueues[i];
+            lean_inc_ref_n(f, queue->count);
+            for (size_t j = 0; j < queue->count; ++j) {
+                lean_inc(queue->objs[j]);
+                lean_apply_1(f, queue->objs[j]);
+            }
+        }
         if (data_->interruptCallback != NULL) {
             lean_inc_ref(f);
             lean_inc_ref(data_->interruptCallback);
@@ -72,11 +95,40 @@ static void lean_luau_State_foreach(void* data, b_lean_obj_arg f) {
             lean_inc_ref(data_->panicCallback);
             lean_apply_1(f, data_->panicCallback);
         }
+        if (data_->pendingError != NULL) {
+            lean_inc_ref_n(f, 2);
+            lean_inc(data_->pendingError);
+            lean_apply_1(f, data_->pendingError);
+            lean_inc(data_->pendingIOError);
+            lean_apply_1(f, data_->pendingIOError);
+        }
     }
 }
 
+static void lean_luau_StrBuf_finalize(void* data) {
+    lean_luau_StrBuf_data* data_ = data;
+    lean_dec_ref(data_->state);
+    lean_pod_free(data_);
+}
+
+static void lean_luau_StrBuf_foreach(void* data, b_lean_obj_arg f) {
+    lean_luau_StrBuf_data* data_ = data;
+    lean_inc_ref(f);
+    lean_inc_ref(data_->state);
+    lean_apply_1(f, data_->state);
+}
+
+static void lean_luau_Bundle_finalize(void* data) {
+    lean_luau_Bundle_unmap(data);
+    lean_pod_free(data);
+}
+
+static void lean_luau_Bundle_foreach(void* data, b_lean_obj_arg f) {}
+
 LEAN_EXPORT lean_obj_res lean_luau_initialize(lean_obj_arg io_) {
     LEAN_POD_INITIALIZE_EXTERNAL_CLASS(luau_CompileOptions, lean_luau_CompileOptions_finalize, lean_luau_CompileOptions_foreach);
     LEAN_POD_INITIALIZE_EXTERNAL_CLASS(luau_State, lean_luau_State_finalize, lean_luau_State_foreach);
+    LEAN_POD_INITIALIZE_EXTERNAL_CLASS(luau_StrBuf, lean_luau_StrBuf_finalize, lean_luau_StrBuf_foreach);
+    LEAN_POD_INITIALIZE_EXTERNAL_CLASS(luau_Bundle, lean_luau_Bundle_finalize, lean_luau_Bundle_foreach);
     return lean_io_result_mk_ok(lean_box(0));
 }
@@ -0,0 +1,195 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+// Log-linear latency buckets: every power of two of nanoseconds is split into 4 sub-buckets.
+#define LEAN_LUAU_HIST_SUB_BITS 2
+#define LEAN_LUAU_HIST_BUCKETS (64 << LEAN_LUAU_HIST_SUB_BITS)
+
+struct lean_luau_fn_stats {
+    char* name;
+    _Atomic uint64_t calls;
+    _Atomic uint64_t errors;
+    _Atomic uint64_t unwound;
+    _Atomic uint64_t totalNanos;
+    _Atomic uint64_t maxNanos;
+    _Atomic uint64_t buckets[LEAN_LUAU_HIST_BUCKETS];
+    lean_luau_fn_stats* next;
+};
+
+static atomic_bool lean_luau_instrumentation_enabled = false;
+// Entries are never freed, so closures may keep pointers to them.
+static _Atomic(lean_luau_fn_stats*) lean_luau_instrumentation_head = NULL;
+// Only taken when a closure is created, calls don't lock.
+static atomic_flag lean_luau_instrumentation_lock = ATOMIC_FLAG_INIT;
+
+lean_luau_fn_stats* lean_luau_instrumentation_lookup(const char* name) {
+    if (!atomic_load_explicit(&lean_luau_instrumentation_enabled, memory_order_relaxed)) {
+        return NULL;
+    }
+    if (name == NULL) {
+        name = "?";
+    }
+    while (atomic_flag_test_and_set_explicit(&lean_luau_instrumentation_lock, memory_order_acquire));
+    lean_luau_fn_stats* stats = atomic_load_explicit(&lean_luau_instrumentation_head, memory_order_relaxed);
+    while (stats != NULL && strcmp(stats->name, name) != 0) {
+        stats = stats->next;
+    }
+    if (stats == NULL) {
+        stats = calloc(1, sizeof(lean_luau_fn_stats));
+        if (stats != NULL) {
+            size_t len = strlen(name);
+            stats->name = malloc(len + 1);
+            if (stats->name == NULL) {
+                free(stats);
+                stats = NULL;
+            }
+            else {
+                memcpy(stats->name, name, len + 1);
+                stats->next = atomic_load_explicit(&lean_luau_instrumentation_head, memory_order_relaxed);
+                atomic_store_explicit(&lean_luau_instrumentation_head, stats, memory_order_release);
+            }
+        }
+    }
+    atomic_flag_clear_explicit(&lean_luau_instrumentation_lock, memory_order_release);
+    return stats;
+}
+
+static size_t lean_luau_hist_bucket(uint64_t nanos) {
+    if (nanos < (1u << LEAN_LUAU_HIST_SUB_BITS)) {
+        return (size_t)nanos;
+    }
+    int msb = 63;
+    while (!(nanos >> msb)) --msb;
+    size_t sub = (size_t)(nanos >> (msb - LEAN_LUAU_HIST_SUB_BITS)) & ((1u << LEAN_LUAU_HIST_SUB_BITS) - 1);
+    return ((size_t)(msb - LEAN_LUAU_HIST_SUB_BITS + 1) << LEAN_LUAU_HIST_SUB_BITS) + sub;
+}
+
+static uint64_t lean_luau_hist_lower_bound(size_t bucket) {
+    if (bucket < (1u << LEAN_LUAU_HIST_SUB_BITS)) {
+        return bucket;
+    }
+    size_t msb = (bucket >> LEAN_LUAU_HIST_SUB_BITS) + LEAN_LUAU_HIST_SUB_BITS - 1;
+    uint64_t sub = bucket & ((1u << LEAN_LUAU_HIST_SUB_BITS) - 1);
+    return (((uint64_t)1 << LEAN_LUAU_HIST_SUB_BITS) | sub) << (msb - LEAN_LUAU_HIST_SUB_BITS);
+}
+
+// Calls in progress on this OS thread, innermost last.
+// A call left by `lua_error` longjmps past its exit, so its frame is settled later:
+// by the exit of an enclosing call, by the next call entered at the same C stack depth or above,
+// or by `lean_luau_instrumentation_settle` once a protected call returned.
+// The C stack is assumed to grow downwards.
+#define LEAN_LUAU_INFLIGHT_MAX 256
+
+typedef struct {
+    lean_luau_fn_stats* stats;
+    double start;
+    const void* sp;
+} lean_luau_inflight;
+
+static _Thread_local lean_luau_inflight lean_luau_inflight_frames[LEAN_LUAU_INFLIGHT_MAX];
+static _Thread_local int lean_luau_inflight_depth = 0;
+
+static void lean_luau_instrumentation_unwind(int depth) {
+    while (lean_luau_inflight_depth > depth) {
+        lean_luau_fn_stats* stats = lean_luau_inflight_frames[--lean_luau_inflight_depth].stats;
+        atomic_fetch_add_explicit(&stats->errors, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&stats->unwound, 1, memory_order_relaxed);
+    }
+}
+
+void lean_luau_instrumentation_settle(const void* sp) {
+    int depth = lean_luau_inflight_depth;
+    while (depth > 0 && (const char*)lean_luau_inflight_frames[depth - 1].sp <= (const char*)sp) {
+        --depth;
+    }
+    lean_luau_instrumentation_unwind(depth);
+}
+
+int lean_luau_instrumentation_enter(lean_luau_fn_stats* stats, const void* sp) {
+    if (lean_luau_inflight_depth > 0) {
+        lean_luau_instrumentation_settle(sp);
+    }
+    if (stats == NULL || lean_luau_inflight_depth >= LEAN_LUAU_INFLIGHT_MAX
+        || !atomic_load_explicit(&lean_luau_instrumentation_enabled, memory_order_relaxed)) {
+        return -1;
+    }
+    // Counted before dispatch, so that calls which never return are still seen
+    atomic_fetch_add_explicit(&stats->calls, 1, memory_order_relaxed);
+    lean_luau_inflight* frame = &lean_luau_inflight_frames[lean_luau_inflight_depth];
+    frame->stats = stats;
+    frame->sp = sp;
+    frame->start = lua_clock();
+    return lean_luau_inflight_depth++;
+}
+
+void lean_luau_instrumentation_leave(int frame, int error) {
+    double end = lua_clock();
+    // Inner calls still in progress were unwound by errors caught within this call
+    lean_luau_instrumentation_unwind(frame + 1);
+    lean_luau_inflight* f = &lean_luau_inflight_frames[frame];
+    lean_luau_fn_stats* stats = f->stats;
+    double elapsed = end - f->start;
+    lean_luau_inflight_depth = frame;
+    uint64_t nanos = elapsed > 0 ? (uint64_t)(elapsed * 1e9) : 0;
+    if (error) {
+        atomic_fetch_add_explicit(&stats->errors, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&stats->totalNanos, nanos, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&stats->maxNanos, memory_order_relaxed);
+    while (nanos > max && !atomic_compare_exchange_weak_explicit(&stats->maxNanos, &max, nanos, memory_order_relaxed, memory_order_relaxed));
+    atomic_fetch_add_explicit(&stats->buckets[lean_luau_hist_bucket(nanos)], 1, memory_order_relaxed);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_Instrumentation_setEnabled(uint8_t enabled, lean_obj_arg io_) {
+    atomic_store_explicit(&lean_luau_instrumentation_enabled, enabled != 0, memory_order_relaxed);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_Instrumentation_reset(lean_obj_arg io_) {
+    lean_luau_fn_stats* stats = atomic_load_explicit(&lean_luau_instrumentation_head, memory_order_acquire);
+    for (; stats != NULL; stats = stats->next) {
+        atomic_store_explicit(&stats->calls, 0, memory_order_relaxed);
+        atomic_store_explicit(&stats->errors, 0, memory_order_relaxed);
+        atomic_store_explicit(&stats->unwound, 0, memory_order_relaxed);
+        atomic_store_explicit(&stats->totalNanos, 0, memory_order_relaxed);
+        atomic_store_explicit(&stats->maxNanos, 0, memory_order_relaxed);
+        for (size_t i = 0; i < LEAN_LUAU_HIST_BUCKETS; ++i) {
+            atomic_store_explicit(&stats->buckets[i], 0, memory_order_relaxed);
+        }
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_Instrumentation_snapshot(lean_obj_arg io_) {
+    lean_object* res = lean_mk_empty_array();
+    lean_luau_fn_stats* stats = atomic_load_explicit(&lean_luau_instrumentation_head, memory_order_acquire);
+    for (; stats != NULL; stats = stats->next) {
+        lean_object* histogram = lean_mk_empty_array();
+        for (size_t i = 0; i < LEAN_LUAU_HIST_BUCKETS; ++i) {
+            uint64_t count = atomic_load_explicit(&stats->buckets[i], memory_order_relaxed);
+            if (count != 0) {
+                histogram = lean_array_push(histogram, lean_mk_tuple2(
+                    lean_box_uint64(lean_luau_hist_lower_bound(i)),
+                    lean_box_uint64(count)
+                ));
+            }
+        }
+        // Object fields first, then the scalars in declaration order
+        lean_object* entry = lean_alloc_ctor(0, 2, 5 * sizeof(uint64_t));
+        lean_ctor_set(entry, 0, lean_mk_string(stats->name));
+        lean_ctor_set(entry, 1, histogram);
+        lean_ctor_set_uint64(entry, 2 * sizeof(void*), atomic_load_explicit(&stats->calls, memory_order_relaxed));
+        lean_ctor_set_uint64(entry, 2 * sizeof(void*) + 8, atomic_load_explicit(&stats->errors, memory_order_relaxed));
+        lean_ctor_set_uint64(entry, 2 * sizeof(void*) + 16, atomic_load_explicit(&stats->unwound, memory_order_relaxed));
+        lean_ctor_set_uint64(entry, 2 * sizeof(void*) + 24, atomic_load_explicit(&stats->totalNanos, memory_order_relaxed));
+        lean_ctor_set_uint64(entry, 2 * sizeof(void*) + 32, atomic_load_explicit(&stats->maxNanos, memory_order_relaxed));
+        res = lean_array_push(res, entry);
+    }
+    return lean_io_result_mk_ok(res);
+}
@@ -0,0 +1,708 @@
+#include <locale.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+#define LEAN_LUAU_JSON_DEFAULT_DEPTH 128
+// Number of parsed elements (pairs for objects) kept on the stack before they are moved into the table.
+// Tables not exceeding this size are created with their exact size.
+#define LEAN_LUAU_JSON_ARRAY_CHUNK 128
+#define LEAN_LUAU_JSON_OBJECT_CHUNK 64
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || defined(_WIN32)
+#define LEAN_LUAU_JSON_LITTLE_ENDIAN 1
+#endif
+
+
+// Word-at-a-time scanning
+
+#define LEAN_LUAU_SWAR_ONES 0x0101010101010101ULL
+#define LEAN_LUAU_SWAR_HIGHS 0x8080808080808080ULL
+
+static inline uint64_t lean_luau_swar_load(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(uint64_t));
+    return v;
+}
+
+// Nonzero if some byte of `v` is less than `n` (`n` <= 128).
+static inline uint64_t lean_luau_swar_has_less(uint64_t v, uint8_t n) {
+    return (v - LEAN_LUAU_SWAR_ONES * n) & ~v & LEAN_LUAU_SWAR_HIGHS;
+}
+
+static inline uint64_t lean_luau_swar_has_byte(uint64_t v, uint8_t c) {
+    return lean_luau_swar_has_less(v ^ (LEAN_LUAU_SWAR_ONES * c), 1);
+}
+
+// Nonzero if some byte of `v` has to be escaped in a JSON string (or ends it).
+static inline uint64_t lean_luau_json_swar_special(uint64_t v) {
+    return lean_luau_swar_has_byte(v, '"') | lean_luau_swar_has_byte(v, '\\') | lean_luau_swar_has_less(v, 0x20);
+}
+
+static inline const uint8_t* lean_luau_json_skip_plain(const uint8_t* p, const uint8_t* end) {
+    while (end - p >= 8 && !lean_luau_json_swar_special(lean_luau_swar_load(p))) {
+        p += 8;
+    }
+    return p;
+}
+
+
+// Decoding
+
+typedef struct {
+    lua_State* state;
+    const uint8_t* begin;
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t depthLeft;
+    const char* error;
+} lean_luau_json_parser;
+
+static int lean_luau_json_fail(lean_luau_json_parser* ps, const char* error) {
+    ps->error = error;
+    return 0;
+}
+
+static inline void lean_luau_json_skip_ws(lean_luau_json_parser* ps) {
+    while (ps->p < ps->end && (*ps->p == ' ' || *ps->p == '\n' || *ps->p == '\r' || *ps->p == '\t')) {
+        ++ps->p;
+    }
+}
+
+static int lean_luau_json_hex4(lean_luau_json_parser* ps, uint32_t* res) {
+    if (ps->end - ps->p < 4) return lean_luau_json_fail(ps, "Unexpected end of input.");
+    uint32_t x = 0;
+    for (int i = 0; i < 4; ++i) {
+        uint8_t c = ps->p[i];
+        x <<= 4;
+        if (c >= '0' && c <= '9') x |= c - '0';
+        else if (c >= 'a' && c <= 'f') x |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') x |= c - 'A' + 10;
+        else return lean_luau_json_fail(ps, "Invalid unicode escape.");
+    }
+    ps->p += 4;
+    *res = x;
+    return 1;
+}
+
+static void lean_luau_json_add_utf8(luaL_Strbuf* buf, uint32_t c) {
+    if (c < 0x80) {
+        luaL_addchar(buf, (char)c);
+    }
+    else if (c < 0x800) {
+        luaL_addchar(buf, (char)(0xC0 | (c >> 6)));
+        luaL_addchar(buf, (char)(0x80 | (c & 0x3F)));
+    }
+    else if (c < 0x10000) {
+        luaL_addchar(buf, (char)(0xE0 | (c >> 12)));
+        luaL_addchar(buf, (char)(0x80 | ((c >> 6) & 0x3F)));
+        luaL_addchar(buf, (char)(0x80 | (c & 0x3F)));
+    }
+    else {
+        luaL_addchar(buf, (char)(0xF0 | (c >> 18)));
+        luaL_addchar(buf, (char)(0x80 | ((c >> 12) & 0x3F)));
+        luaL_addchar(buf, (char)(0x80 | ((c >> 6) & 0x3F)));
+        luaL_addchar(buf, (char)(0x80 | (c & 0x3F)));
+    }
+}
+
+// Strings with escapes are assembled in a string builder.
+static int lean_luau_json_parse_escaped(lean_luau_json_parser* ps, const uint8_t* start) {
+    luaL_Strbuf buf;
+    luaL_buffinit(ps->state, &buf);
+    luaL_addlstring(&buf, (const char*)start, ps->p - start);
+    for (;;) {
+        start = ps->p;
+        for (;;) {
+            ps->p = lean_luau_json_skip_plain(ps->p, ps->end);
+            if (ps->p >= ps->end) return lean_luau_json_fail(ps, "Unterminated string.");
+            uint8_t c = *ps->p;
+            if (c == '"' || c == '\\') break;
+            if (c < 0x20) return lean_luau_json_fail(ps, "Control character in string.");
+            ++ps->p;
+        }
+        luaL_addlstring(&buf, (const char*)start, ps->p - start);
+        if (*ps->p == '"') {
+            ++ps->p;
+            luaL_pushresult(&buf);
+            return 1;
+        }
+        if (++ps->p >= ps->end) return lean_luau_json_fail(ps, "Unterminated string.");
+        switch (*ps->p++) {
+            case '"': luaL_addchar(&buf, '"'); break;
+            case '\\': luaL_addchar(&buf, '\\'); break;
+            case '/': luaL_addchar(&buf, '/'); break;
+            case 'b': luaL_addchar(&buf, '\b'); break;
+            case 'f': luaL_addchar(&buf, '\f'); break;
+            case 'n': luaL_addchar(&buf, '\n'); break;
+            case 'r': luaL_addchar(&buf, '\r'); break;
+            case 't': luaL_addchar(&buf, '\t'); break;
+            case 'u': {
+                uint32_t c;
+                if (!lean_luau_json_hex4(ps, &c)) return 0;
+                if (c >= 0xD800 && c < 0xDC00) {
+                    uint32_t low;
+                    if (ps->end - ps->p < 2 || ps->p[0] != '\\' || ps->p[1] != 'u') {
+                        return lean_luau_json_fail(ps, "Unpaired surrogate.");
+                    }
+                    ps->p += 2;
+                    if (!lean_luau_json_hex4(ps, &low)) return 0;
+                    if (low < 0xDC00 || low >= 0xE000) return lean_luau_json_fail(ps, "Unpaired surrogate.");
+                    c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else if (c >= 0xDC00 && c < 0xE000) {
+                    return lean_luau_json_fail(ps, "Unpaired surrogate.");
+                }
+                lean_luau_json_add_utf8(&buf, c);
+                break;
+            }
+            default:
+                return lean_luau_json_fail(ps, "Invalid escape.");
+        }
+    }
+}
+
+static int lean_luau_json_parse_string(lean_luau_json_parser* ps) {
+    const uint8_t* start = ++ps->p;
+    for (;;) {
+        ps->p = lean_luau_json_skip_plain(ps->p, ps->end);
+        if (ps->p >= ps->end) return lean_luau_json_fail(ps, "Unterminated string.");
+        uint8_t c = *ps->p;
+        if (c == '"') {
+            lua_pushlstring(ps->state, (const char*)start, ps->p - start);
+            ++ps->p;
+            return 1;
+        }
+        if (c == '\\') return lean_luau_json_parse_escaped(ps, start);
+        if (c < 0x20) return lean_luau_json_fail(ps, "Control character in string.");
+        ++ps->p;
+    }
+}
+
+#ifdef LEAN_LUAU_JSON_LITTLE_ENDIAN
+static inline int lean_luau_swar_is_eight_digits(uint64_t v) {
+    return ((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+static inline uint32_t lean_luau_swar_parse_eight_digits(uint64_t v) {
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+        (((v >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+    return (uint32_t)v;
+}
+#endif
+
+static const double lean_luau_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Accumulates a run of digits into `m` while it has at most 19 digits.
+static inline void lean_luau_json_digits(lean_luau_json_parser* ps, uint64_t* m, int* nd, int* dropped) {
+#ifdef LEAN_LUAU_JSON_LITTLE_ENDIAN
+    while (ps->end - ps->p >= 8 && *nd + 8 <= 19 && lean_luau_swar_is_eight_digits(lean_luau_swar_load(ps->p))) {
+        *m = *m * 100000000 + lean_luau_swar_parse_eight_digits(lean_luau_swar_load(ps->p));
+        *nd += 8;
+        ps->p += 8;
+    }
+#endif
+    while (ps->p < ps->end && *ps->p >= '0' && *ps->p <= '9') {
+        if (*nd < 19) {
+            *m = *m * 10 + (*ps->p - '0');
+            ++*nd;
+        }
+        else {
+            ++*dropped;
+        }
+        ++ps->p;
+    }
+}
+
+static int lean_luau_json_parse_number(lean_luau_json_parser* ps) {
+    const uint8_t* start = ps->p;
+    int neg = 0;
+    if (*ps->p == '-') {
+        neg = 1;
+        ++ps->p;
+    }
+    uint64_t m = 0;
+    int nd = 0; // accumulated digits
+    int dropped = 0; // integer digits past the accumulated ones
+    int exp10 = 0;
+    int exact = 1;
+    if (ps->p < ps->end && *ps->p == '0') {
+        ++ps->p;
+    }
+    else if (ps->p < ps->end && *ps->p >= '1' && *ps->p <= '9') {
+        lean_luau_json_digits(ps, &m, &nd, &dropped);
+    }
+    else {
+        return lean_luau_json_fail(ps, "Invalid number.");
+    }
+    exp10 += dropped;
+    if (ps->p < ps->end && *ps->p == '.') {
+        ++ps->p;
+        const uint8_t* frac = ps->p;
+        int before = nd;
+        int fracDropped = 0;
+        lean_luau_json_digits(ps, &m, &nd, &fracDropped);
+        if (ps->p == frac) return lean_luau_json_fail(ps, "Invalid number.");
+        exp10 -= nd - before;
+        if (fracDropped > 0) exact = 0;
+    }
+    if (ps->p < ps->end && (*ps->p == 'e' || *ps->p == 'E')) {
+        ++ps->p;
+        int expNeg = 0;
+        if (ps->p < ps->end && (*ps->p == '+' || *ps->p == '-')) {
+            expNeg = *ps->p == '-';
+            ++ps->p;
+        }
+        if (ps->p >= ps->end || *ps->p < '0' || *ps->p > '9') return lean_luau_json_fail(ps, "Invalid number.");
+        int e = 0;
+        while (ps->p < ps->end && *ps->p >= '0' && *ps->p <= '9') {
+            if (e < 100000) e = e * 10 + (*ps->p - '0');
+            ++ps->p;
+        }
+        exp10 += expNeg ? -e : e;
+    }
+    double n;
+    if (exact && dropped == 0 && m <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        // Both the mantissa and the power of ten are exact, so is the result
+        n = (double)m;
+        n = exp10 < 0 ? n / lean_luau_pow10[-exp10] : n * lean_luau_pow10[exp10];
+        if (neg) n = -n;
+    }
+    else {
+        char small[64];
+        size_t len = ps->p - start;
+        char* copy = len < sizeof(small) ? small : malloc(len + 1);
+        if (copy == NULL) return lean_luau_json_fail(ps, "Out of memory.");
+        memcpy(copy, start, len);
+        copy[len] = '\0';
+        // `strtod` expects the decimal point of the current C locale
+        char point = localeconv()->decimal_point[0];
+        if (point != '.') {
+            char* dot = memchr(copy, '.', len);
+            if (dot != NULL) *dot = point;
+        }
+        n = strtod(copy, NULL);
+        if (copy != small) free(copy);
+    }
+    lua_pushnumber(ps->state, n);
+    return 1;
+}
+
+static int lean_luau_json_parse_value(lean_luau_json_parser* ps);
+
+// Moves the values above the table at `base` (or above `base - 1` if there's no table yet) into the table.
+static void lean_luau_json_flush_array(lua_State* state, int base, int* created, int* count, int pending) {
+    if (!*created) {
+        lua_createtable(state, pending, 0);
+        lua_insert(state, base);
+        *created = 1;
+    }
+    for (int i = pending; i >= 1; --i) {
+        lua_rawseti(state, base, *count + i);
+    }
+    *count += pending;
+}
+
+static void lean_luau_json_flush_object(lua_State* state, int base, int* created, int pending) {
+    if (!*created) {
+        lua_createtable(state, 0, pending);
+        lua_insert(state, base);
+        *created = 1;
+    }
+    // In order, so that later duplicate keys win
+    for (int i = 0; i < pending; ++i) {
+        lua_pushvalue(state, base + 1 + 2 * i);
+        lua_pushvalue(state, base + 2 + 2 * i);
+        lua_rawset(state, base);
+    }
+    lua_settop(state, base);
+}
+
+static int lean_luau_json_parse_array(lean_luau_json_parser* ps) {
+    lua_State* state = ps->state;
+    ++ps->p;
+    lean_luau_json_skip_ws(ps);
+    if (ps->p < ps->end && *ps->p == ']') {
+        ++ps->p;
+        lua_createtable(state, 0, 0);
+        return 1;
+    }
+    int base = lua_gettop(state) + 1;
+    int created = 0;
+    int count = 0;
+    int pending = 0;
+    for (;;) {
+        if (!lean_luau_json_parse_value(ps)) return 0;
+        if (++pending == LEAN_LUAU_JSON_ARRAY_CHUNK) {
+            lean_luau_json_flush_array(state, base, &created, &count, pending);
+            pending = 0;
+        }
+        lean_luau_json_skip_ws(ps);
+        if (ps->p >= ps->end) return lean_luau_json_fail(ps, "Unexpected end of input.");
+        if (*ps->p == ']') {
+            ++ps->p;
+            break;
+        }
+        if (*ps->p != ',') return lean_luau_json_fail(ps, "Expected ',' or ']'.");
+        ++ps->p;
+        lean_luau_json_skip_ws(ps);
+    }
+    lean_luau_json_flush_array(state, base, &created, &count, pending);
+    return 1;
+}
+
+static int lean_luau_json_parse_object(lean_luau_json_parser* ps) {
+    lua_State* state = ps->state;
+    ++ps->p;
+    lean_luau_json_skip_ws(ps);
+    if (ps->p < ps->end && *ps->p == '}') {
+        ++ps->p;
+        lua_createtable(state, 0, 0);
+        return 1;
+    }
+    int base = lua_gettop(state) + 1;
+    int created = 0;
+    int pending = 0;
+    for (;;) {
+        if (ps->p >= ps->end || *ps->p != '"') return lean_luau_json_fail(ps, "Expected a string key.");
+        if (!lean_luau_json_parse_string(ps)) return 0;
+        lean_luau_json_skip_ws(ps);
+        if (ps->p >= ps->end || *ps->p != ':') return lean_luau_json_fail(ps, "Expected ':'.");
+        ++ps->p;
+        lean_luau_json_skip_ws(ps);
+        if (!lean_luau_json_parse_value(ps)) return 0;
+        if (++pending == LEAN_LUAU_JSON_OBJECT_CHUNK) {
+            lean_luau_json_flush_object(state, base, &created, pending);
+            pending = 0;
+        }
+        lean_luau_json_skip_ws(ps);
+        if (ps->p >= ps->end) return lean_luau_json_fail(ps, "Unexpected end of input.");
+        if (*ps->p == '}') {
+            ++ps->p;
+            break;
+        }
+        if (*ps->p != ',') return lean_luau_json_fail(ps, "Expected ',' or '}'.");
+        ++ps->p;
+        lean_luau_json_skip_ws(ps);
+    }
+    lean_luau_json_flush_object(state, base, &created, pending);
+    return 1;
+}
+
+static int lean_luau_json_parse_literal(lean_luau_json_parser* ps, const char* lit, size_t len) {
+    if ((size_t)(ps->end - ps->p) < len || memcmp(ps->p, lit, len) != 0) {
+        return lean_luau_json_fail(ps, "Invalid literal.");
+    }
+    ps->p += len;
+    return 1;
+}
+
+// Pushes the parsed value. On failure the stack is left unbalanced, the caller restores it.
+static int lean_luau_json_parse_value(lean_luau_json_parser* ps) {
+    if (!lua_checkstack(ps->state, 4)) return lean_luau_json_fail(ps, "Stack overflow.");
+    if (ps->p >= ps->end) return lean_luau_json_fail(ps, "Unexpected end of input.");
+    switch (*ps->p) {
+        case '{':
+        case '[': {
+            if (ps->depthLeft == 0) return lean_luau_json_fail(ps, "Depth limit exceeded.");
+            --ps->depthLeft;
+            int ok = *ps->p == '{' ? lean_luau_json_parse_object(ps) : lean_luau_json_parse_array(ps);
+            ++ps->depthLeft;
+            return ok;
+        }
+        case '"':
+            return lean_luau_json_parse_string(ps);
+        case 't':
+            if (!lean_luau_json_parse_literal(ps, "true", 4)) return 0;
+            lua_pushboolean(ps->state, 1);
+            return 1;
+        case 'f':
+            if (!lean_luau_json_parse_literal(ps, "false", 5)) return 0;
+            lua_pushboolean(ps->state, 0);
+            return 1;
+        case 'n':
+            if (!lean_luau_json_parse_literal(ps, "null", 4)) return 0;
+            lua_pushnil(ps->state);
+            return 1;
+        default:
+            return lean_luau_json_parse_number(ps);
+    }
+}
+
+// Pushes the parsed document, or leaves the stack unchanged and returns 0 on failure.
+static int lean_luau_json_parse(lua_State* state, const uint8_t* bytes, size_t size, uint32_t maxDepth, lean_luau_json_parser* ps) {
+    ps->state = state;
+    ps->begin = bytes;
+    ps->p = bytes;
+    ps->end = bytes + size;
+    ps->depthLeft = maxDepth;
+    ps->error = NULL;
+    int top = lua_gettop(state);
+    lean_luau_json_skip_ws(ps);
+    int ok = lean_luau_json_parse_value(ps);
+    if (ok) {
+        lean_luau_json_skip_ws(ps);
+        if (ps->p != ps->end) ok = lean_luau_json_fail(ps, "Trailing characters.");
+    }
+    if (!ok) {
+        lua_settop(state, top);
+    }
+    return ok;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_pushJson(lean_luau_State state, b_lean_obj_arg sz, lean_pod_BytesView bytes, uint32_t maxDepth, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_json_parser ps;
+    if (!lean_luau_json_parse(data->state, lean_pod_BytesView_fromRepr(bytes)->ptr, lean_usize_of_nat(sz), maxDepth, &ps)) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "Invalid JSON at byte %zu: %s", (size_t)(ps.p - ps.begin), ps.error);
+        return lean_luau_ioerr(msg);
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+
+// Encoding
+
+typedef struct {
+    lua_State* state;
+    lean_object* out;
+    uint32_t depthLeft;
+    const char* error;
+} lean_luau_json_writer;
+
+static inline uint8_t* lean_luau_json_put(lean_luau_json_writer* w, size_t n) {
+    w->out = lean_luau_ByteArray_reserve(w->out, n);
+    size_t size = lean_sarray_size(w->out);
+    lean_to_sarray(w->out)->m_size = size + n;
+    return lean_sarray_cptr(w->out) + size;
+}
+
+static inline void lean_luau_json_put_bytes(lean_luau_json_writer* w, const void* bytes, size_t n) {
+    memcpy(lean_luau_json_put(w, n), bytes, n);
+}
+
+static void lean_luau_json_write_string(lean_luau_json_writer* w, const char* s, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    const uint8_t* p = (const uint8_t*)s;
+    const uint8_t* end = p + len;
+    w->out = lean_luau_ByteArray_reserve(w->out, len + 2);
+    *lean_luau_json_put(w, 1) = '"';
+    while (p < end) {
+        const uint8_t* start = p;
+        p = lean_luau_json_skip_plain(p, end);
+        while (p < end && *p != '"' && *p != '\\' && *p >= 0x20) ++p;
+        lean_luau_json_put_bytes(w, start, p - start);
+        if (p >= end) break;
+        uint8_t c = *p++;
+        char esc = 0;
+        switch (c) {
+            case '"': esc = '"'; break;
+            case '\\': esc = '\\'; break;
+            case '\b': esc = 'b'; break;
+            case '\f': esc = 'f'; break;
+            case '\n': esc = 'n'; break;
+            case '\r': esc = 'r'; break;
+            case '\t': esc = 't'; break;
+        }
+        if (esc != 0) {
+            uint8_t* dst = lean_luau_json_put(w, 2);
+            dst[0] = '\\';
+            dst[1] = esc;
+        }
+        else {
+            uint8_t* dst = lean_luau_json_put(w, 6);
+            memcpy(dst, "\\u00", 4);
+            dst[4] = hex[c >> 4];
+            dst[5] = hex[c & 0xF];
+        }
+    }
+    *lean_luau_json_put(w, 1) = '"';
+}
+
+static int lean_luau_json_write_number(lean_luau_json_writer* w, double n) {
+    if (!isfinite(n)) {
+        w->error = "Can't encode NaN or infinity.";
+        return 0;
+    }
+    char buf[32];
+    int len;
+    if (n == floor(n) && fabs(n) < 9007199254740992.0) {
+        len = snprintf(buf, sizeof(buf), "%lld", (long long)n);
+    }
+    else {
+        // Luau's own conversion is the shortest that round-trips and doesn't depend on the C locale
+        if (!lua_checkstack(w->state, 1)) {
+            w->error = "Stack overflow.";
+            return 0;
+        }
+        size_t slen;
+        lua_pushnumber(w->state, n);
+        const char* s = lua_tolstring(w->state, -1, &slen);
+        lean_luau_json_put_bytes(w, s, slen);
+        lua_pop(w->state, 1);
+        return 1;
+    }
+    lean_luau_json_put_bytes(w, buf, len);
+    return 1;
+}
+
+static int lean_luau_json_write_value(lean_luau_json_writer* w, int idx);
+
+static int lean_luau_json_write_table(lean_luau_json_writer* w, int idx) {
+    lua_State* state = w->state;
+    if (w->depthLeft == 0) {
+        w->error = "Depth limit exceeded (or the table is cyclic).";
+        return 0;
+    }
+    if (!lua_checkstack(state, 3)) {
+        w->error = "Stack overflow.";
+        return 0;
+    }
+    --w->depthLeft;
+    int n = lua_objlen(state, idx);
+    int count = 0;
+    int iter = 0;
+    while ((iter = lua_rawiter(state, idx, iter)) >= 0) {
+        lua_pop(state, 2);
+        ++count;
+    }
+    if (count == n) {
+        // Sequences, including the empty table, are encoded as arrays
+        *lean_luau_json_put(w, 1) = '[';
+        for (int i = 1; i <= n; ++i) {
+            if (i > 1) *lean_luau_json_put(w, 1) = ',';
+            lua_rawgeti(state, idx, i);
+            int ok = lean_luau_json_write_value(w, -1);
+            lua_pop(state, 1);
+            if (!ok) return 0;
+        }
+        *lean_luau_json_put(w, 1) = ']';
+    }
+    else {
+        *lean_luau_json_put(w, 1) = '{';
+        int first = 1;
+        iter = 0;
+        while ((iter = lua_rawiter(state, idx, iter)) >= 0) {
+            if (lua_type(state, -2) != LUA_TSTRING) {
+                lua_pop(state, 2);
+                w->error = "Object keys must be strings.";
+                return 0;
+            }
+            if (!first) *lean_luau_json_put(w, 1) = ',';
+            first = 0;
+            size_t len;
+            const char* key = lua_tolstring(state, -2, &len);
+            lean_luau_json_write_string(w, key, len);
+            *lean_luau_json_put(w, 1) = ':';
+            int ok = lean_luau_json_write_value(w, -1);
+            lua_pop(state, 2);
+            if (!ok) return 0;
+        }
+        *lean_luau_json_put(w, 1) = '}';
+    }
+    ++w->depthLeft;
+    return 1;
+}
+
+static int lean_luau_json_write_value(lean_luau_json_writer* w, int idx) {
+    lua_State* state = w->state;
+    switch (lua_type(state, idx)) {
+        case LUA_TNIL:
+            lean_luau_json_put_bytes(w, "null", 4);
+            return 1;
+        case LUA_TBOOLEAN:
+            if (lua_toboolean(state, idx)) lean_luau_json_put_bytes(w, "true", 4);
+            else lean_luau_json_put_bytes(w, "false", 5);
+            return 1;
+        case LUA_TNUMBER:
+            return lean_luau_json_write_number(w, lua_tonumber(state, idx));
+        case LUA_TSTRING: {
+            size_t len;
+            const char* s = lua_tolstring(state, idx, &len);
+            lean_luau_json_write_string(w, s, len);
+            return 1;
+        }
+        case LUA_TTABLE:
+            return lean_luau_json_write_table(w, lua_absindex(state, idx));
+        default:
+            w->error = "Only nil, booleans, numbers, strings and tables can be encoded.";
+            return 0;
+    }
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_toJson(lean_luau_State state, uint32_t idx, lean_obj_arg out, uint32_t maxDepth, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec_ref(out);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    lean_luau_json_writer w;
+    w.state = data->state;
+    w.out = lean_luau_ByteArray_clear(out);
+    w.depthLeft = maxDepth;
+    w.error = NULL;
+    int top = lua_gettop(data->state);
+    int ok = lean_luau_json_write_value(&w, lua_absindex(data->state, (int32_t)idx));
+    lua_settop(data->state, top);
+    if (!ok) {
+        lean_dec_ref(w.out);
+        return lean_luau_ioerr(w.error);
+    }
+    return lean_io_result_mk_ok(w.out);
+}
+
+
+// Library
+
+static int lean_luau_json_decode(lua_State* state) {
+    size_t len;
+    const char* s = luaL_checklstring(state, 1, &len);
+    lean_luau_json_parser ps;
+    if (!lean_luau_json_parse(state, (const uint8_t*)s, len, LEAN_LUAU_JSON_DEFAULT_DEPTH, &ps)) {
+        luaL_error(state, "invalid JSON at byte %d: %s", (int)(ps.p - ps.begin), ps.error);
+    }
+    return 1;
+}
+
+static int lean_luau_json_encode(lua_State* state) {
+    luaL_checkany(state, 1);
+    lean_luau_json_writer w;
+    w.state = state;
+    w.out = lean_alloc_sarray(1, 0, 256);
+    w.depthLeft = LEAN_LUAU_JSON_DEFAULT_DEPTH;
+    w.error = NULL;
+    int ok = lean_luau_json_write_value(&w, 1);
+    if (!ok) {
+        lean_dec_ref(w.out);
+        luaL_error(state, "%s", w.error);
+    }
+    lua_pushlstring(state, (const char*)lean_sarray_cptr(w.out), lean_sarray_size(w.out));
+    lean_dec_ref(w.out);
+    return 1;
+}
+
+static const luaL_Reg lean_luau_json_funcs[] = {
+    {"decode", lean_luau_json_decode},
+    {"encode", lean_luau_json_encode},
+    {NULL, NULL},
+};
+
+LEAN_EXPORT lean_obj_res lean_luau_State_openJson(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    luaL_register(data->state, "json", lean_luau_json_funcs);
+    return lean_io_result_mk_ok(lean_box(0));
+}
@@ -0,0 +1,209 @@
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+// Proxy constructors
+#define LEAN_LUAU_PROXY_ARRAY 0
+#define LEAN_LUAU_PROXY_RECORD 1
+
+// Record fields: size, keys (thunk), lookup
+#define LEAN_LUAU_PROXY_RECORD_SIZE 0
+#define LEAN_LUAU_PROXY_RECORD_KEYS 1
+#define LEAN_LUAU_PROXY_RECORD_LOOKUP 2
+
+// Upvalues of the metamethods: tag, per-proxy caches (weak keys)
+static b_lean_obj_arg lean_luau_proxy_get(lua_State* state, int idx) {
+    int tag = lua_tointeger(state, lua_upvalueindex(1));
+    lean_luau_userdata_tagged* ud = lua_touserdatatagged(state, idx, tag);
+    if (ud == NULL) {
+        luaL_typeerrorL(state, idx, "proxy");
+    }
+    return ud->obj;
+}
+
+static size_t lean_luau_proxy_size(b_lean_obj_arg proxy) {
+    if (lean_obj_tag(proxy) == LEAN_LUAU_PROXY_ARRAY) {
+        return lean_array_size(lean_ctor_get(proxy, 0));
+    }
+    b_lean_obj_arg size = lean_ctor_get(proxy, LEAN_LUAU_PROXY_RECORD_SIZE);
+    return lean_is_scalar(size) ? lean_unbox(size) : SIZE_MAX;
+}
+
+// Pushes `proxy[key]` for the record proxy at index 1, the key being at index `key`.
+static void lean_luau_proxy_lookup(lua_State* state, b_lean_obj_arg proxy, int key) {
+    // Converted values are cached per proxy
+    lua_pushvalue(state, 1);
+    lua_rawget(state, lua_upvalueindex(2));
+    if (lua_isnil(state, -1)) {
+        lua_pop(state, 1);
+        lua_newtable(state);
+        lua_pushvalue(state, 1);
+        lua_pushvalue(state, -2);
+        lua_rawset(state, lua_upvalueindex(2));
+    }
+    lua_pushvalue(state, key);
+    lua_rawget(state, -2);
+    if (!lua_isnil(state, -1)) {
+        lua_remove(state, -2);
+        return;
+    }
+    lua_pop(state, 1);
+    size_t len;
+    const char* s = lua_tolstring(state, key, &len);
+    b_lean_obj_arg lookup = lean_ctor_get(proxy, LEAN_LUAU_PROXY_RECORD_LOOKUP);
+    lean_inc(lookup);
+    lean_object* res = lean_apply_1(lookup, lean_mk_string_from_bytes(s, len));
+    if (lean_obj_tag(res) == 0) {
+        lua_pop(state, 1);
+        lua_pushnil(state);
+        return;
+    }
+    lean_luau_Value_push(state, lean_ctor_get(res, 0));
+    lean_dec(res);
+    lua_pushvalue(state, key);
+    lua_pushvalue(state, -2);
+    lua_rawset(state, -4);
+    lua_remove(state, -2);
+}
+
+static int lean_luau_proxy_index(lua_State* state) {
+    b_lean_obj_arg proxy = lean_luau_proxy_get(state, 1);
+    if (lean_obj_tag(proxy) == LEAN_LUAU_PROXY_ARRAY) {
+        b_lean_obj_arg values = lean_ctor_get(proxy, 0);
+        int isnum;
+        int i = lua_tointegerx(state, 2, &isnum);
+        if (!isnum || i < 1 || (size_t)i > lean_array_size(values) || (double)i != lua_tonumber(state, 2)) {
+            lua_pushnil(state);
+            return 1;
+        }
+        lean_luau_Value_push(state, lean_array_get_core(values, i - 1));
+        return 1;
+    }
+    if (lua_type(state, 2) != LUA_TSTRING) {
+        lua_pushnil(state);
+        return 1;
+    }
+    lean_luau_proxy_lookup(state, proxy, 2);
+    return 1;
+}
+
+static int lean_luau_proxy_newindex(lua_State* state) {
+    luaL_error(state, "attempt to modify a readonly proxy");
+    return 0;
+}
+
+static int lean_luau_proxy_len(lua_State* state) {
+    size_t size = lean_luau_proxy_size(lean_luau_proxy_get(state, 1));
+    lua_pushnumber(state, (double)size);
+    return 1;
+}
+
+// Stateful iterator, the position is kept in upvalue 3 and the control variable is ignored.
+static int lean_luau_proxy_next(lua_State* state) {
+    b_lean_obj_arg proxy = lean_luau_proxy_get(state, 1);
+    int i = lua_tointeger(state, lua_upvalueindex(3));
+    if (lean_obj_tag(proxy) == LEAN_LUAU_PROXY_ARRAY) {
+        b_lean_obj_arg values = lean_ctor_get(proxy, 0);
+        if ((size_t)i >= lean_array_size(values)) return 0;
+        lua_pushinteger(state, i + 1);
+        lua_replace(state, lua_upvalueindex(3));
+        lua_pushinteger(state, i + 1);
+        lean_luau_Value_push(state, lean_array_get_core(values, i));
+        return 2;
+    }
+    b_lean_obj_arg keys = lean_thunk_get(lean_ctor_get(proxy, LEAN_LUAU_PROXY_RECORD_KEYS));
+    if ((size_t)i >= lean_array_size(keys)) return 0;
+    lua_pushinteger(state, i + 1);
+    lua_replace(state, lua_upvalueindex(3));
+    b_lean_obj_arg key = lean_array_get_core(keys, i);
+    lua_pushlstring(state, lean_string_cstr(key), lean_string_size(key) - 1);
+    lean_luau_proxy_lookup(state, proxy, lua_gettop(state));
+    return 2;
+}
+
+// Generalized iteration: (index, value) for arrays, (key, value) for records
+static int lean_luau_proxy_iter(lua_State* state) {
+    lean_luau_proxy_get(state, 1);
+    lua_pushvalue(state, lua_upvalueindex(1));
+    lua_pushvalue(state, lua_upvalueindex(2));
+    lua_pushinteger(state, 0);
+    lua_pushcclosure(state, lean_luau_proxy_next, "proxy_next", 3);
+    lua_pushvalue(state, 1);
+    lua_pushnil(state);
+    return 3;
+}
+
+static int lean_luau_proxy_tostring(lua_State* state) {
+    b_lean_obj_arg proxy = lean_luau_proxy_get(state, 1);
+    lua_pushfstring(state, "proxy: %s (%d)", lean_obj_tag(proxy) == LEAN_LUAU_PROXY_ARRAY ? "array" : "record", (int)lean_luau_proxy_size(proxy));
+    return 1;
+}
+
+static const luaL_Reg lean_luau_proxy_meta[] = {
+    {"__index", lean_luau_proxy_index},
+    {"__newindex", lean_luau_proxy_newindex},
+    {"__len", lean_luau_proxy_len},
+    {"__iter", lean_luau_proxy_iter},
+    {"__tostring", lean_luau_proxy_tostring},
+    {NULL, NULL},
+};
+
+LEAN_EXPORT lean_obj_res lean_luau_State_registerProxyTag(lean_luau_State state, uint32_t tag, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    if (!lua_checkstack(L, 4)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    int top = lua_gettop(L);
+    lua_getuserdatametatable(L, tag);
+    int taken = !lua_isnil(L, -1);
+    lua_pop(L, 1);
+    if (taken || lua_getuserdatadtor(L, tag) != NULL || data->main->podTags[tag]) {
+        return lean_luau_ioerr("Tag is already in use.");
+    }
+    lua_setuserdatadtor(L, tag, lean_luau_userdata_tagged_dtor);
+    data->main->proxyTags[tag] = 1;
+    lua_newtable(L);
+    lua_newtable(L); // caches
+    lua_newtable(L);
+    lua_pushstring(L, "k");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);
+    for (const luaL_Reg* reg = lean_luau_proxy_meta; reg->name != NULL; ++reg) {
+        lua_pushinteger(L, (int32_t)tag);
+        lua_pushvalue(L, -2);
+        lua_pushcclosure(L, reg->func, reg->name, 2);
+        lua_setfield(L, -3, reg->name);
+    }
+    lua_pop(L, 1);
+    lua_pushstring(L, "proxy");
+    lua_setfield(L, -2, "__type");
+    lua_pushstring(L, "locked");
+    lua_setfield(L, -2, "__metatable");
+    lua_setuserdatametatable(L, tag, -1);
+    lua_settop(L, top);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_pushProxy(lean_luau_State state, uint32_t tag, lean_obj_arg proxy, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec(proxy);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    if (!data->main->proxyTags[tag]) {
+        lean_dec(proxy);
+        return lean_luau_ioerr("Tag is not registered for proxies.");
+    }
+    // The data may be shared by states running on other threads
+    lean_mark_mt(proxy);
+    lean_luau_userdata_tagged* dst = lua_newuserdatataggedwithmetatable(data->state, sizeof(lean_luau_userdata_tagged), tag);
+    dst->obj = proxy;
+    dst->tag = tag;
+    dst->main = data->main;
+    dst->externalSize = 0;
+    return lean_io_result_mk_ok(lean_box(0));
+}
@@ -0,0 +1,371 @@
+#include <string.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+// Binary format:
+// - a version byte followed by a single value;
+// - each value starts with a type byte, multibyte integers are little-endian;
+// - strings and buffers are a LEB128 length followed by the bytes;
+// - tables are the array part size and the hash part size (u32 each),
+//   followed by the array part values and then by the hash part key-value pairs.
+
+#define LEAN_LUAU_ENCODING_VERSION 1
+
+#define LEAN_LUAU_ENC_NIL 0
+#define LEAN_LUAU_ENC_FALSE 1
+#define LEAN_LUAU_ENC_TRUE 2
+#define LEAN_LUAU_ENC_INT32 3
+#define LEAN_LUAU_ENC_NUMBER 4
+#define LEAN_LUAU_ENC_STRING 5
+#define LEAN_LUAU_ENC_BUFFER 6
+#define LEAN_LUAU_ENC_VECTOR 7
+#define LEAN_LUAU_ENC_TABLE 8
+
+
+// Encoding
+
+typedef struct {
+    lua_State* state;
+    lean_object* out;
+    uint32_t depthLeft;
+    size_t maxBytes;
+    const char* error;
+} lean_luau_encoder;
+
+static int lean_luau_encoder_reserve(lean_luau_encoder* enc, size_t extra) {
+    if (extra > enc->maxBytes - lean_sarray_size(enc->out)) {
+        enc->error = "Size limit exceeded.";
+        return 0;
+    }
+    enc->out = lean_luau_ByteArray_reserve(enc->out, extra);
+    return 1;
+}
+
+// The space must be reserved beforehand
+static inline uint8_t* lean_luau_encoder_advance(lean_luau_encoder* enc, size_t n) {
+    size_t size = lean_sarray_size(enc->out);
+    lean_to_sarray(enc->out)->m_size = size + n;
+    return lean_sarray_cptr(enc->out) + size;
+}
+
+static inline void lean_luau_put_u32(uint8_t* dst, uint32_t x) {
+    dst[0] = (uint8_t)x;
+    dst[1] = (uint8_t)(x >> 8);
+    dst[2] = (uint8_t)(x >> 16);
+    dst[3] = (uint8_t)(x >> 24);
+}
+
+static inline void lean_luau_put_u64(uint8_t* dst, uint64_t x) {
+    lean_luau_put_u32(dst, (uint32_t)x);
+    lean_luau_put_u32(dst + 4, (uint32_t)(x >> 32));
+}
+
+static int lean_luau_encode_bytes(lean_luau_encoder* enc, uint8_t type, const void* data, size_t len) {
+    if (!lean_luau_encoder_reserve(enc, 1 + 10 + len)) return 0;
+    *lean_luau_encoder_advance(enc, 1) = type;
+    size_t x = len;
+    do {
+        uint8_t byte = x & 0x7F;
+        x >>= 7;
+        *lean_luau_encoder_advance(enc, 1) = byte | (x != 0 ? 0x80 : 0);
+    } while (x != 0);
+    memcpy(lean_luau_encoder_advance(enc, len), data, len);
+    return 1;
+}
+
+static int lean_luau_encode_value(lean_luau_encoder* enc, int idx);
+
+static int lean_luau_encode_table(lean_luau_encoder* enc, int idx) {
+    lua_State* state = enc->state;
+    if (enc->depthLeft == 0) {
+        enc->error = "Depth limit exceeded (or the table is cyclic).";
+        return 0;
+    }
+    if (!lua_checkstack(state, 2)) {
+        enc->error = "Stack overflow.";
+        return 0;
+    }
+    --enc->depthLeft;
+    int narr = lua_objlen(state, idx);
+    if (!lean_luau_encoder_reserve(enc, 9)) return 0;
+    *lean_luau_encoder_advance(enc, 1) = LEAN_LUAU_ENC_TABLE;
+    lean_luau_put_u32(lean_luau_encoder_advance(enc, 4), (uint32_t)narr);
+    size_t nrecPos = lean_sarray_size(enc->out);
+    lean_luau_encoder_advance(enc, 4);
+    for (int i = 1; i <= narr; ++i) {
+        lua_rawgeti(state, idx, i);
+        int ok = lean_luau_encode_value(enc, -1);
+        lua_pop(state, 1);
+        if (!ok) return 0;
+    }
+    uint32_t nrec = 0;
+    int iter = 0;
+    while ((iter = lua_rawiter(state, idx, iter)) >= 0) {
+        if (lua_type(state, -2) == LUA_TNUMBER) {
+            double k = lua_tonumber(state, -2);
+            if (k >= 1 && k <= narr && k == (double)(int)k) {
+                lua_pop(state, 2);
+                continue;
+            }
+        }
+        int ok = lean_luau_encode_value(enc, -2) && lean_luau_encode_value(enc, -1);
+        lua_pop(state, 2);
+        if (!ok) return 0;
+        ++nrec;
+    }
+    lean_luau_put_u32(lean_sarray_cptr(enc->out) + nrecPos, nrec);
+    ++enc->depthLeft;
+    return 1;
+}
+
+static int lean_luau_encode_value(lean_luau_encoder* enc, int idx) {
+    lua_State* state = enc->state;
+    switch (lua_type(state, idx)) {
+        case LUA_TNIL:
+            if (!lean_luau_encoder_reserve(enc, 1)) return 0;
+            *lean_luau_encoder_advance(enc, 1) = LEAN_LUAU_ENC_NIL;
+            return 1;
+        case LUA_TBOOLEAN:
+            if (!lean_luau_encoder_reserve(enc, 1)) return 0;
+            *lean_luau_encoder_advance(enc, 1) = lua_toboolean(state, idx) ? LEAN_LUAU_ENC_TRUE : LEAN_LUAU_ENC_FALSE;
+            return 1;
+        case LUA_TNUMBER: {
+            double n = lua_tonumber(state, idx);
+            if (!lean_luau_encoder_reserve(enc, 9)) return 0;
+            if (n >= -2147483648.0 && n <= 2147483647.0 && n == (double)(int32_t)n && !(n == 0 && 1 / n < 0)) {
+                *lean_luau_encoder_advance(enc, 1) = LEAN_LUAU_ENC_INT32;
+                lean_luau_put_u32(lean_luau_encoder_advance(enc, 4), (uint32_t)(int32_t)n);
+            }
+            else {
+                uint64_t bits;
+                memcpy(&bits, &n, sizeof(double));
+                *lean_luau_encoder_advance(enc, 1) = LEAN_LUAU_ENC_NUMBER;
+                lean_luau_put_u64(lean_luau_encoder_advance(enc, 8), bits);
+            }
+            return 1;
+        }
+        case LUA_TVECTOR: {
+            const float* v = lua_tovector(state, idx);
+            if (!lean_luau_encoder_reserve(enc, 1 + 4 * sizeof(float))) return 0;
+            *lean_luau_encoder_advance(enc, 1) = LEAN_LUAU_ENC_VECTOR;
+            for (int i = 0; i < 4; ++i) {
+                float x = i < LUA_VECTOR_SIZE ? v[i] : 0.0f;
+                uint32_t bits;
+                memcpy(&bits, &x, sizeof(float));
+                lean_luau_put_u32(lean_luau_encoder_advance(enc, 4), bits);
+            }
+            return 1;
+        }
+        case LUA_TSTRING: {
+            size_t len;
+            const char* s = lua_tolstring(state, idx, &len);
+            return lean_luau_encode_bytes(enc, LEAN_LUAU_ENC_STRING, s, len);
+        }
+        case LUA_TBUFFER: {
+            size_t len;
+            void* bytes = lua_tobuffer(state, idx, &len);
+            return lean_luau_encode_bytes(enc, LEAN_LUAU_ENC_BUFFER, bytes, len);
+        }
+        case LUA_TTABLE:
+            return lean_luau_encode_table(enc, lua_absindex(state, idx));
+        default:
+            enc->error = "Can't encode functions, userdata and threads.";
+            return 0;
+    }
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_encode(
+    lean_luau_State state, uint32_t idx, lean_obj_arg out,
+    uint32_t maxDepth, size_t maxBytes, lean_obj_arg io_
+) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec_ref(out);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    lean_luau_encoder enc;
+    enc.state = data->state;
+    enc.out = lean_luau_ByteArray_clear(out);
+    enc.depthLeft = maxDepth;
+    enc.maxBytes = maxBytes;
+    enc.error = NULL;
+    int top = lua_gettop(data->state);
+    int ok = lean_luau_encoder_reserve(&enc, 1);
+    if (ok) {
+        *lean_luau_encoder_advance(&enc, 1) = LEAN_LUAU_ENCODING_VERSION;
+        ok = lean_luau_encode_value(&enc, lua_absindex(data->state, (int32_t)idx));
+    }
+    lua_settop(data->state, top);
+    if (!ok) {
+        lean_dec_ref(enc.out);
+        return lean_luau_ioerr(enc.error);
+    }
+    return lean_io_result_mk_ok(enc.out);
+}
+
+
+// Decoding
+
+typedef struct {
+    lua_State* state;
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t depthLeft;
+    const char* error;
+} lean_luau_decoder;
+
+static inline uint32_t lean_luau_get_u32(const uint8_t* src) {
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16) | ((uint32_t)src[3] << 24);
+}
+
+static int lean_luau_decoder_truncated(lean_luau_decoder* dec) {
+    dec->error = "Unexpected end of data.";
+    return 0;
+}
+
+static int lean_luau_decode_length(lean_luau_decoder* dec, size_t* len) {
+    size_t x = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (dec->p >= dec->end) return lean_luau_decoder_truncated(dec);
+        uint8_t byte = *dec->p++;
+        x |= (size_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            if (x > (size_t)(dec->end - dec->p)) return lean_luau_decoder_truncated(dec);
+            *len = x;
+            return 1;
+        }
+    }
+    dec->error = "Malformed length.";
+    return 0;
+}
+
+// Pushes the decoded value, returns 0 without pushing anything on failure.
+static int lean_luau_decode_value(lean_luau_decoder* dec) {
+    lua_State* state = dec->state;
+    if (!lua_checkstack(state, 3)) {
+        dec->error = "Stack overflow.";
+        return 0;
+    }
+    if (dec->p >= dec->end) return lean_luau_decoder_truncated(dec);
+    switch (*dec->p++) {
+        case LEAN_LUAU_ENC_NIL:
+            lua_pushnil(state);
+            return 1;
+        case LEAN_LUAU_ENC_FALSE:
+            lua_pushboolean(state, 0);
+            return 1;
+        case LEAN_LUAU_ENC_TRUE:
+            lua_pushboolean(state, 1);
+            return 1;
+        case LEAN_LUAU_ENC_INT32:
+            if (dec->end - dec->p < 4) return lean_luau_decoder_truncated(dec);
+            lua_pushnumber(state, (double)(int32_t)lean_luau_get_u32(dec->p));
+            dec->p += 4;
+            return 1;
+        case LEAN_LUAU_ENC_NUMBER: {
+            if (dec->end - dec->p < 8) return lean_luau_decoder_truncated(dec);
+            uint64_t bits = (uint64_t)lean_luau_get_u32(dec->p) | ((uint64_t)lean_luau_get_u32(dec->p + 4) << 32);
+            double n;
+            memcpy(&n, &bits, sizeof(double));
+            lua_pushnumber(state, n);
+            dec->p += 8;
+            return 1;
+        }
+        case LEAN_LUAU_ENC_VECTOR: {
+            if (dec->end - dec->p < 16) return lean_luau_decoder_truncated(dec);
+            float v[4];
+            for (int i = 0; i < 4; ++i) {
+                uint32_t bits = lean_luau_get_u32(dec->p + 4 * i);
+                memcpy(&v[i], &bits, sizeof(float));
+            }
+#if LUA_VECTOR_SIZE == 4
+            lua_pushvector(state, v[0], v[1], v[2], v[3]);
+#else
+            lua_pushvector(state, v[0], v[1], v[2]);
+#endif
+            dec->p += 16;
+            return 1;
+        }
+        case LEAN_LUAU_ENC_STRING: {
+            size_t len;
+            if (!lean_luau_decode_length(dec, &len)) return 0;
+            lua_pushlstring(state, (const char*)dec->p, len);
+            dec->p += len;
+            return 1;
+        }
+        case LEAN_LUAU_ENC_BUFFER: {
+            size_t len;
+            if (!lean_luau_decode_length(dec, &len)) return 0;
+            memcpy(lua_newbuffer(state, len), dec->p, len);
+            dec->p += len;
+            return 1;
+        }
+        case LEAN_LUAU_ENC_TABLE: {
+            if (dec->depthLeft == 0) {
+                dec->error = "Depth limit exceeded.";
+                return 0;
+            }
+            if (dec->end - dec->p < 8) return lean_luau_decoder_truncated(dec);
+            uint32_t narr = lean_luau_get_u32(dec->p);
+            uint32_t nrec = lean_luau_get_u32(dec->p + 4);
+            dec->p += 8;
+            // Every value takes at least one byte, don't let a corrupted header preallocate a huge table
+            if (narr > (size_t)(dec->end - dec->p) || nrec > (size_t)(dec->end - dec->p) / 2) {
+                return lean_luau_decoder_truncated(dec);
+            }
+            --dec->depthLeft;
+            lua_createtable(state, (int)narr, (int)nrec);
+            int t = lua_gettop(state);
+            for (uint32_t i = 1; i <= narr; ++i) {
+                if (!lean_luau_decode_value(dec)) {
+                    lua_settop(state, t - 1);
+                    return 0;
+                }
+                lua_rawseti(state, t, (int)i);
+            }
+            for (uint32_t i = 0; i < nrec; ++i) {
+                if (!lean_luau_decode_value(dec) || !lean_luau_decode_value(dec)) {
+                    lua_settop(state, t - 1);
+                    return 0;
+                }
+                if (lua_isnil(state, -2) || (lua_isnumber(state, -2) && lua_tonumber(state, -2) != lua_tonumber(state, -2))) {
+                    dec->error = "Invalid table key.";
+                    lua_settop(state, t - 1);
+                    return 0;
+                }
+                lua_rawset(state, t);
+            }
+            ++dec->depthLeft;
+            return 1;
+        }
+        default:
+            dec->error = "Unknown value type.";
+            return 0;
+    }
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_decode(lean_luau_State state, b_lean_obj_arg bytes, uint32_t maxDepth, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_decoder dec;
+    dec.state = data->state;
+    dec.p = lean_sarray_cptr(bytes);
+    dec.end = dec.p + lean_sarray_size(bytes);
+    dec.depthLeft = maxDepth;
+    dec.error = NULL;
+    if (dec.p >= dec.end || *dec.p != LEAN_LUAU_ENCODING_VERSION) {
+        return lean_luau_ioerr("Unsupported encoding version.");
+    }
+    ++dec.p;
+    if (!lean_luau_decode_value(&dec)) {
+        return lean_luau_ioerr(dec.error);
+    }
+    if (dec.p != dec.end) {
+        lua_pop(data->state, 1);
+        return lean_luau_ioerr("Trailing data after the encoded value.");
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
@@ -0,0 +1,99 @@
+#include <stdlib.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+static void lean_luau_thread_stats_userthread(lua_State* parent, lua_State* state) {
+    if (parent != NULL) return;
+    // The thread is being destroyed
+    lean_luau_thread_stats* stats = lua_getthreaddata(state);
+    if (stats == NULL) return;
+    lean_luau_State_data* main = lean_luau_State_unbox(lua_callbacks(state)->userdata);
+    if (main->threadAccounting.current == stats) {
+        main->threadAccounting.current = NULL;
+    }
+    lua_setthreaddata(state, NULL);
+    free(stats);
+}
+
+lean_luau_thread_stats* lean_luau_thread_stats_of(lua_State* state) {
+    lean_luau_thread_stats* stats = lua_getthreaddata(state);
+    if (stats == NULL) {
+        stats = calloc(1, sizeof(lean_luau_thread_stats));
+        lua_setthreaddata(state, stats);
+    }
+    return stats;
+}
+
+void lean_luau_thread_stats_onallocate(lua_State* state, size_t osize, size_t nsize) {
+    if (nsize <= osize) return;
+    lean_luau_thread_stats* stats = lean_luau_thread_stats_of(state);
+    if (stats == NULL) return;
+    stats->allocatedBytes += nsize - osize;
+    ++stats->allocations;
+}
+
+void lean_luau_thread_accounting_checkpoint(lean_luau_State_data* main, lean_luau_thread_stats* next) {
+    lean_luau_thread_accounting* acc = &main->threadAccounting;
+    double now = lua_clock();
+    if (acc->current != NULL && now > acc->last) {
+        acc->current->cpuNanos += (uint64_t)((now - acc->last) * 1e9);
+    }
+    acc->current = next;
+    acc->last = now;
+}
+
+void lean_luau_thread_accounting_close(lean_luau_State_data* main) {
+    // Other threads are released by the userthread callback
+    free(lua_getthreaddata(main->state));
+    lua_setthreaddata(main->state, NULL);
+    main->threadAccounting.enabled = 0;
+    main->threadAccounting.current = NULL;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_setThreadAccounting(lean_luau_State state, uint8_t enabled, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_thread_accounting* acc = &data->main->threadAccounting;
+    if (enabled && !acc->enabled) {
+        // Kept installed once set, it frees the counters of dying threads
+        lua_callbacks(data->state)->userthread = lean_luau_thread_stats_userthread;
+        acc->current = NULL;
+        acc->last = lua_clock();
+    }
+    acc->enabled = enabled;
+    lean_luau_State_updateCallbacks(data->main);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_threadStats(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_thread_stats* stats = lua_getthreaddata(data->state);
+    lean_luau_thread_accounting* acc = &data->main->threadAccounting;
+    if (stats != NULL && acc->enabled && acc->current == stats) {
+        // Include the time since the last checkpoint
+        lean_luau_thread_accounting_checkpoint(data->main, stats);
+    }
+    lean_object* res = lean_alloc_ctor(0, 0, 4 * sizeof(uint64_t));
+    lean_ctor_set_uint64(res, 0, stats != NULL ? stats->cpuNanos : 0);
+    lean_ctor_set_uint64(res, 8, stats != NULL ? stats->allocatedBytes : 0);
+    lean_ctor_set_uint64(res, 16, stats != NULL ? stats->allocations : 0);
+    lean_ctor_set_uint64(res, 24, stats != NULL ? stats->resumes : 0);
+    return lean_io_result_mk_ok(res);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_resetThreadStats(lean_luau_State state, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_thread_stats* stats = lua_getthreaddata(data->state);
+    if (stats != NULL) {
+        stats->cpuNanos = 0;
+        stats->allocatedBytes = 0;
+        stats->allocations = 0;
+        stats->resumes = 0;
+    }
+    return lean_io_result_mk_ok(lean_box(0));
+}
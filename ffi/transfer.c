@@ -0,0 +1,217 @@
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+// Approximate cost of a copied value, excluding string/buffer payloads
+#define LEAN_LUAU_COPY_VALUE_COST 16
+
+typedef struct {
+    lua_State* src;
+    lua_State* dst;
+    lean_luau_State_data* srcMain;
+    lean_luau_State_data* dstMain;
+    int seen; // dst table mapping source tables (as light userdata) to their copies
+    uint32_t depthLeft;
+    size_t bytesLeft;
+    const char* error;
+} lean_luau_copy_ctx;
+
+static int lean_luau_copy_charge(lean_luau_copy_ctx* ctx, size_t size) {
+    size += LEAN_LUAU_COPY_VALUE_COST;
+    if (size > ctx->bytesLeft) {
+        ctx->error = "Size limit exceeded.";
+        return 0;
+    }
+    ctx->bytesLeft -= size;
+    return 1;
+}
+
+static void lean_luau_copy_userdata_metatable(lua_State* dst, int tag) {
+    lua_getuserdatametatable(dst, tag);
+    if (lua_istable(dst, -1)) {
+        lua_setmetatable(dst, -2);
+    }
+    else {
+        lua_pop(dst, 1);
+    }
+}
+
+// Pushes a copy of the source value onto the destination stack.
+// Returns 0 without pushing anything and sets `ctx->error` on failure.
+static int lean_luau_copy(lean_luau_copy_ctx* ctx, int idx) {
+    lua_State* src = ctx->src;
+    lua_State* dst = ctx->dst;
+    if (!lua_checkstack(dst, 4) || !lua_checkstack(src, 3)) {
+        ctx->error = "Stack overflow.";
+        return 0;
+    }
+    switch (lua_type(src, idx)) {
+        case LUA_TNIL:
+            if (!lean_luau_copy_charge(ctx, 0)) return 0;
+            lua_pushnil(dst);
+            return 1;
+        case LUA_TBOOLEAN:
+            if (!lean_luau_copy_charge(ctx, 0)) return 0;
+            lua_pushboolean(dst, lua_toboolean(src, idx));
+            return 1;
+        case LUA_TNUMBER:
+            if (!lean_luau_copy_charge(ctx, 0)) return 0;
+            lua_pushnumber(dst, lua_tonumber(src, idx));
+            return 1;
+        case LUA_TVECTOR: {
+            if (!lean_luau_copy_charge(ctx, 0)) return 0;
+            const float* v = lua_tovector(src, idx);
+#if LUA_VECTOR_SIZE == 4
+            lua_pushvector(dst, v[0], v[1], v[2], v[3]);
+#else
+            lua_pushvector(dst, v[0], v[1], v[2]);
+#endif
+            return 1;
+        }
+        case LUA_TSTRING: {
+            size_t len;
+            const char* s = lua_tolstring(src, idx, &len);
+            if (!lean_luau_copy_charge(ctx, len)) return 0;
+            lua_pushlstring(dst, s, len);
+            return 1;
+        }
+        case LUA_TBUFFER: {
+            size_t len;
+            void* bytes = lua_tobuffer(src, idx, &len);
+            if (!lean_luau_copy_charge(ctx, len)) return 0;
+            memcpy(lua_newbuffer(dst, len), bytes, len);
+            return 1;
+        }
+        case LUA_TUSERDATA: {
+            int tag = lua_userdatatag(src, idx);
+            void* ud = lua_touserdata(src, idx);
+            size_t len = lua_objlen(src, idx);
+            if (tag < LUA_UTAG_LIMIT && lua_getuserdatadtor(src, tag) == lean_luau_userdata_tagged_dtor) {
+                if (ctx->dstMain->podTags[tag]) {
+                    ctx->error = "Tag is used by plain-data userdata in the destination state.";
+                    return 0;
+                }
+                if (ctx->srcMain->proxyTags[tag] != ctx->dstMain->proxyTags[tag]) {
+                    ctx->error = "Tag is used by proxies in only one of the states.";
+                    return 0;
+                }
+                if (!lean_luau_copy_charge(ctx, 0)) return 0;
+                lua_setuserdatadtor(dst, tag, lean_luau_userdata_tagged_dtor);
+                lean_luau_userdata_tagged* from = ud;
+                lean_luau_userdata_tagged* to = lua_newuserdatatagged(dst, sizeof(lean_luau_userdata_tagged), tag);
+                lean_inc(from->obj);
+                to->obj = from->obj;
+                to->tag = tag;
+                to->main = ctx->dstMain;
+                // The payload is shared, so it is declared in both states
+                to->externalSize = from->externalSize;
+                ctx->dstMain->externalBytes += from->externalSize;
+                lean_luau_copy_userdata_metatable(dst, tag);
+                return 1;
+            }
+            if (tag < LUA_UTAG_LIMIT && ctx->srcMain->podTags[tag]) {
+                // Plain-data userdata, other tagged userdata may hold native pointers
+                if (lua_getuserdatadtor(dst, tag) != NULL) {
+                    ctx->error = "Tag is used by userdata with a destructor in the destination state.";
+                    return 0;
+                }
+                if (!lean_luau_copy_charge(ctx, len)) return 0;
+                ctx->dstMain->podTags[tag] = 1;
+                memcpy(lua_newuserdatatagged(dst, len, tag), ud, len);
+                lean_luau_copy_userdata_metatable(dst, tag);
+                return 1;
+            }
+            lean_luau_userdata* from = lean_luau_userdata_to(src, idx);
+            if (from != NULL) {
+                // The Lean destructor would run once per copy on the shared object
+                if (from->dtor != NULL) {
+                    ctx->error = "Can't copy userdata with a destructor.";
+                    return 0;
+                }
+                if (!lean_luau_copy_charge(ctx, 0)) return 0;
+                lean_luau_userdata* to = lua_newuserdatadtor(dst, sizeof(lean_luau_userdata), lean_luau_userdata_dtor);
+                lean_inc(from->obj);
+                to->obj = from->obj;
+                to->dtor = NULL;
+                to->main = ctx->dstMain;
+                to->externalSize = from->externalSize;
+                ctx->dstMain->externalBytes += from->externalSize;
+                return 1;
+            }
+            ctx->error = "Can't copy foreign userdata.";
+            return 0;
+        }
+        case LUA_TTABLE: {
+            int srcIdx = lua_absindex(src, idx);
+            lua_pushlightuserdata(dst, (void*)lua_topointer(src, srcIdx));
+            lua_rawget(dst, ctx->seen);
+            if (!lua_isnil(dst, -1)) {
+                return 1;
+            }
+            lua_pop(dst, 1);
+            if (ctx->depthLeft == 0) {
+                ctx->error = "Depth limit exceeded.";
+                return 0;
+            }
+            if (!lean_luau_copy_charge(ctx, 0)) return 0;
+            --ctx->depthLeft;
+            lua_createtable(dst, lua_objlen(src, srcIdx), 0);
+            int dstIdx = lua_gettop(dst);
+            lua_pushlightuserdata(dst, (void*)lua_topointer(src, srcIdx));
+            lua_pushvalue(dst, dstIdx);
+            lua_rawset(dst, ctx->seen);
+            int iter = 0;
+            while ((iter = lua_rawiter(src, srcIdx, iter)) >= 0) {
+                if (!lean_luau_copy(ctx, -2)) {
+                    lua_pop(src, 2);
+                    lua_settop(dst, dstIdx - 1);
+                    return 0;
+                }
+                if (!lean_luau_copy(ctx, -1)) {
+                    lua_pop(src, 2);
+                    lua_settop(dst, dstIdx - 1);
+                    return 0;
+                }
+                lua_rawset(dst, dstIdx);
+                lua_pop(src, 2);
+            }
+            if (lua_getreadonly(src, srcIdx)) {
+                lua_setreadonly(dst, dstIdx, 1);
+            }
+            ++ctx->depthLeft;
+            return 1;
+        }
+        default:
+            ctx->error = "Can't copy functions, threads and light userdata.";
+            return 0;
+    }
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_copyValue(
+    lean_luau_State src, uint32_t idx, lean_luau_State dst,
+    uint32_t maxDepth, size_t maxBytes, lean_obj_arg io_
+) {
+    lean_luau_State_data* src_data = lean_luau_State_fromRepr(src);
+    lean_luau_State_data* dst_data = lean_luau_State_fromRepr(dst);
+    lean_luau_guard_valid(src_data);
+    lean_luau_guard_valid(dst_data);
+    lean_luau_copy_ctx ctx;
+    ctx.src = src_data->state;
+    ctx.dst = dst_data->state;
+    ctx.srcMain = src_data->main;
+    ctx.dstMain = dst_data->main;
+    ctx.depthLeft = maxDepth;
+    ctx.bytesLeft = maxBytes;
+    ctx.error = NULL;
+    int srcIdx = lua_absindex(ctx.src, (int32_t)idx);
+    lua_newtable(ctx.dst);
+    ctx.seen = lua_gettop(ctx.dst);
+    if (!lean_luau_copy(&ctx, srcIdx)) {
+        lua_settop(ctx.dst, ctx.seen - 1);
+        return lean_luau_ioerr(ctx.error);
+    }
+    lua_remove(ctx.dst, ctx.seen);
+    return lean_io_result_mk_ok(lean_box(0));
+}
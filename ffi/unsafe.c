@@ -0,0 +1,156 @@
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <luau.lean.h>
+
+// Unchecked variants of the stack manipulation functions: no state validity guard and no error results.
+
+#define lean_luau_unsafe_state(state) (lean_luau_State_fromRepr(state)->state)
+
+
+// Basic stack manipulation
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_absIndex(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box_uint32((int32_t)lua_absindex(lean_luau_unsafe_state(state), (int32_t)idx)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_getTop(lean_luau_State state, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box_uint32((int32_t)lua_gettop(lean_luau_unsafe_state(state))));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_setTop(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lua_settop(lean_luau_unsafe_state(state), (int32_t)idx);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pop(lean_luau_State state, uint32_t n, lean_obj_arg io_) {
+    lua_pop(lean_luau_unsafe_state(state), (int32_t)n);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pushValue(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lua_pushvalue(lean_luau_unsafe_state(state), (int32_t)idx);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_remove(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lua_remove(lean_luau_unsafe_state(state), (int32_t)idx);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_insert(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lua_insert(lean_luau_unsafe_state(state), (int32_t)idx);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_replace(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lua_replace(lean_luau_unsafe_state(state), (int32_t)idx);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_checkStack(lean_luau_State state, uint32_t sz, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box(lua_checkstack(lean_luau_unsafe_state(state), (int32_t)sz) != 0));
+}
+
+
+// Access functions
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_type(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box_uint32((int32_t)lua_type(lean_luau_unsafe_state(state), (int32_t)idx)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_isNil(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box(lua_isnil(lean_luau_unsafe_state(state), (int32_t)idx) != 0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_toNumber(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box_float(lua_tonumber(lean_luau_unsafe_state(state), (int32_t)idx)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_toInteger(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box_uint32((int32_t)lua_tointeger(lean_luau_unsafe_state(state), (int32_t)idx)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_toUnsigned(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box_uint32(lua_tounsigned(lean_luau_unsafe_state(state), (int32_t)idx)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_toBoolean(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box(lua_toboolean(lean_luau_unsafe_state(state), (int32_t)idx) != 0));
+}
+
+
+// Push functions
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pushNil(lean_luau_State state, lean_obj_arg io_) {
+    lua_pushnil(lean_luau_unsafe_state(state));
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pushNumber(lean_luau_State state, double n, lean_obj_arg io_) {
+    lua_pushnumber(lean_luau_unsafe_state(state), n);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pushInteger(lean_luau_State state, uint32_t n, lean_obj_arg io_) {
+    lua_pushinteger(lean_luau_unsafe_state(state), (int32_t)n);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pushUnsigned(lean_luau_State state, uint32_t n, lean_obj_arg io_) {
+    lua_pushunsigned(lean_luau_unsafe_state(state), n);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pushBoolean(lean_luau_State state, uint8_t b, lean_obj_arg io_) {
+    lua_pushboolean(lean_luau_unsafe_state(state), b);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_pushString(lean_luau_State state, b_lean_obj_arg s, lean_obj_arg io_) {
+    lua_pushlstring(lean_luau_unsafe_state(state), lean_string_cstr(s), lean_string_size(s) - 1);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+
+// Get and set functions
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_rawGet(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box(lua_rawget(lean_luau_unsafe_state(state), (int32_t)idx)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_rawGetI(lean_luau_State state, uint32_t idx, uint32_t n, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box(lua_rawgeti(lean_luau_unsafe_state(state), (int32_t)idx, (int32_t)n)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_rawGetField(lean_luau_State state, uint32_t idx, b_lean_obj_arg k, lean_obj_arg io_) {
+    return lean_io_result_mk_ok(lean_box(lua_rawgetfield(lean_luau_unsafe_state(state), (int32_t)idx, lean_string_cstr(k))));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_rawSet(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lua_rawset(lean_luau_unsafe_state(state), (int32_t)idx);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_rawSetI(lean_luau_State state, uint32_t idx, uint32_t n, lean_obj_arg io_) {
+    lua_rawseti(lean_luau_unsafe_state(state), (int32_t)idx, (int32_t)n);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_rawSetField(lean_luau_State state, uint32_t idx, b_lean_obj_arg k, lean_obj_arg io_) {
+    lua_rawsetfield(lean_luau_unsafe_state(state), (int32_t)idx, lean_string_cstr(k));
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_createTable(lean_luau_State state, uint32_t narr, uint32_t nrec, lean_obj_arg io_) {
+    lua_createtable(lean_luau_unsafe_state(state), (int32_t)narr, (int32_t)nrec);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+
+// Call functions
+
+LEAN_EXPORT lean_obj_res lean_luau_State_unsafe_call(lean_luau_State state, uint32_t nArgs, uint32_t nResults, lean_obj_arg io_) {
+    lua_call(lean_luau_unsafe_state(state), (int32_t)nArgs, (int32_t)nResults);
+    return lean_io_result_mk_ok(lean_box(0));
+}
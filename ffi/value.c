@@ -0,0 +1,388 @@
+#include <math.h>
+#include <stdio.h>
+#include <lean/lean.h>
+#include <lean_pod.h>
+#include <lua.h>
+#include <lualib.h>
+#include <luau.lean.h>
+
+// Value constructors
+#define LEAN_LUAU_VALUE_NIL 0
+#define LEAN_LUAU_VALUE_BOOLEAN 1
+#define LEAN_LUAU_VALUE_NUMBER 2
+#define LEAN_LUAU_VALUE_VECTOR 3
+#define LEAN_LUAU_VALUE_STRING 4
+#define LEAN_LUAU_VALUE_BUFFER 5
+#define LEAN_LUAU_VALUE_REF 6
+
+lean_object* lean_luau_Value_read(lua_State* state, int idx, int refs) {
+    int type = lua_type(state, idx);
+    switch (type) {
+        case LUA_TNONE:
+        case LUA_TNIL:
+            return lean_box(LEAN_LUAU_VALUE_NIL);
+        case LUA_TBOOLEAN: {
+            lean_object* res = lean_alloc_ctor(LEAN_LUAU_VALUE_BOOLEAN, 0, 1);
+            lean_ctor_set_uint8(res, 0, lua_toboolean(state, idx) != 0);
+            return res;
+        }
+        case LUA_TNUMBER: {
+            lean_object* res = lean_alloc_ctor(LEAN_LUAU_VALUE_NUMBER, 0, sizeof(double));
+            lean_ctor_set_float(res, 0, lua_tonumber(state, idx));
+            return res;
+        }
+        case LUA_TVECTOR: {
+            const float* v = lua_tovector(state, idx);
+            lean_object* res = lean_alloc_ctor(LEAN_LUAU_VALUE_VECTOR, 0, 4 * sizeof(double));
+            for (int i = 0; i < 4; ++i) {
+                lean_ctor_set_float(res, i * sizeof(double), i < LUA_VECTOR_SIZE ? v[i] : 0.0);
+            }
+            return res;
+        }
+        case LUA_TSTRING: {
+            size_t len;
+            const char* s = lua_tolstring(state, idx, &len);
+            lean_object* res = lean_alloc_ctor(LEAN_LUAU_VALUE_STRING, 1, 0);
+            lean_ctor_set(res, 0, lean_mk_string_from_bytes(s, len));
+            return res;
+        }
+        case LUA_TBUFFER: {
+            size_t len;
+            void* bytes = lua_tobuffer(state, idx, &len);
+            lean_object* ba = lean_alloc_sarray(1, len, len);
+            memcpy(lean_sarray_cptr(ba), bytes, len);
+            lean_object* res = lean_alloc_ctor(LEAN_LUAU_VALUE_BUFFER, 1, 0);
+            lean_ctor_set(res, 0, ba);
+            return res;
+        }
+        default: {
+            // Scalar fields are laid out by decreasing size: the reference, then the type
+            lean_object* res = lean_alloc_ctor(LEAN_LUAU_VALUE_REF, 0, sizeof(uint32_t) + sizeof(uint8_t));
+            lean_ctor_set_uint32(res, 0, (uint32_t)(refs ? lua_ref(state, idx) : LUA_NOREF));
+            lean_ctor_set_uint8(res, sizeof(uint32_t), (uint8_t)type);
+            return res;
+        }
+    }
+}
+
+void lean_luau_Value_push(lua_State* state, b_lean_obj_arg value) {
+    if (lean_is_scalar(value)) {
+        lua_pushnil(state);
+        return;
+    }
+    switch (lean_ptr_tag(value)) {
+        case LEAN_LUAU_VALUE_BOOLEAN:
+            lua_pushboolean(state, lean_ctor_get_uint8(value, 0));
+            break;
+        case LEAN_LUAU_VALUE_NUMBER:
+            lua_pushnumber(state, lean_ctor_get_float(value, 0));
+            break;
+        case LEAN_LUAU_VALUE_VECTOR:
+#if LUA_VECTOR_SIZE == 4
+            lua_pushvector(state,
+                (float)lean_ctor_get_float(value, 0), (float)lean_ctor_get_float(value, sizeof(double)),
+                (float)lean_ctor_get_float(value, 2 * sizeof(double)), (float)lean_ctor_get_float(value, 3 * sizeof(double)));
+#else
+            lua_pushvector(state,
+                (float)lean_ctor_get_float(value, 0), (float)lean_ctor_get_float(value, sizeof(double)),
+                (float)lean_ctor_get_float(value, 2 * sizeof(double)));
+#endif
+            break;
+        case LEAN_LUAU_VALUE_STRING: {
+            lean_object* s = lean_ctor_get(value, 0);
+            lua_pushlstring(state, lean_string_cstr(s), lean_string_size(s) - 1);
+            break;
+        }
+        case LEAN_LUAU_VALUE_BUFFER: {
+            lean_object* ba = lean_ctor_get(value, 0);
+            size_t len = lean_sarray_size(ba);
+            memcpy(lua_newbuffer(state, len), lean_sarray_cptr(ba), len);
+            break;
+        }
+        default: {
+            int ref = (int32_t)lean_ctor_get_uint32(value, 0);
+            if (ref == LUA_NOREF) {
+                lua_pushnil(state);
+            }
+            else {
+                lua_getref(state, ref);
+            }
+            break;
+        }
+    }
+}
+
+// Collects up to `max` entries starting after the iteration position `*iter`, updates `*iter` (-1 when done).
+static lean_object* lean_luau_entries(lua_State* state, int idx, int* iter, size_t max, int refs) {
+    size_t capacity = (size_t)lua_objlen(state, idx);
+    if (capacity < 8) capacity = 8;
+    if (capacity > max) capacity = max;
+    lean_object* entries = lean_alloc_array(0, capacity);
+    while (lean_array_size(entries) < max && (*iter = lua_rawiter(state, idx, *iter)) >= 0) {
+        lean_object* k = lean_luau_Value_read(state, -2, refs);
+        lean_object* v = lean_luau_Value_read(state, -1, refs);
+        lua_pop(state, 2);
+        entries = lean_array_push(entries, lean_mk_tuple2(k, v));
+    }
+    return entries;
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_toValue(lean_luau_State state, uint32_t idx, uint8_t refs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    return lean_io_result_mk_ok(lean_luau_Value_read(data->state, (int32_t)idx, refs));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_pushValue_2(lean_luau_State state, b_lean_obj_arg value, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lean_luau_Value_push(data->state, value);
+    return lean_io_result_mk_ok(lean_box(0));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_rawEntries(lean_luau_State state, uint32_t idx, uint8_t refs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    if (!lua_checkstack(data->state, 2)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    int iter = 0;
+    return lean_io_result_mk_ok(lean_luau_entries(data->state, lua_absindex(data->state, (int32_t)idx), &iter, SIZE_MAX, refs));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_rawEntriesFrom(lean_luau_State state, uint32_t idx, uint32_t iter, size_t max, uint8_t refs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    if (!lua_checkstack(data->state, 2)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    int next = (int32_t)iter;
+    lean_object* entries = lean_luau_entries(data->state, lua_absindex(data->state, (int32_t)idx), &next, max, refs);
+    return lean_io_result_mk_ok(lean_mk_tuple2(entries, lean_box_uint32((uint32_t)next)));
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_rawRecord(lean_luau_State state, uint32_t idx, uint8_t refs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    if (!lua_checkstack(L, 2)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    int t = lua_absindex(L, (int32_t)idx);
+    lean_object* fields = lean_alloc_array(0, 8);
+    int iter = 0;
+    while ((iter = lua_rawiter(L, t, iter)) >= 0) {
+        if (lua_type(L, -2) == LUA_TSTRING) {
+            size_t len;
+            const char* k = lua_tolstring(L, -2, &len);
+            lean_object* v = lean_luau_Value_read(L, -1, refs);
+            fields = lean_array_push(fields, lean_mk_tuple2(lean_mk_string_from_bytes(k, len), v));
+        }
+        lua_pop(L, 2);
+    }
+    return lean_io_result_mk_ok(fields);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_rawArray(lean_luau_State state, uint32_t idx, uint8_t refs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    if (!lua_checkstack(L, 1)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    int t = lua_absindex(L, (int32_t)idx);
+    int n = lua_objlen(L, t);
+    lean_object* values = lean_alloc_array(n, n);
+    for (int i = 1; i <= n; ++i) {
+        lua_rawgeti(L, t, i);
+        lean_array_set_core(values, i - 1, lean_luau_Value_read(L, -1, refs));
+        lua_pop(L, 1);
+    }
+    return lean_io_result_mk_ok(values);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_rawNumberArray(lean_luau_State state, uint32_t idx, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    if (!lua_checkstack(L, 1)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    int t = lua_absindex(L, (int32_t)idx);
+    int n = lua_objlen(L, t);
+    lean_object* values = lean_alloc_sarray(sizeof(double), n, n);
+    double* dst = lean_float_array_cptr(values);
+    for (int i = 1; i <= n; ++i) {
+        lua_rawgeti(L, t, i);
+        int isnum = lua_type(L, -1) == LUA_TNUMBER;
+        dst[i - 1] = lua_tonumber(L, -1);
+        lua_pop(L, 1);
+        if (!isnum) {
+            lean_dec_ref(values);
+            return lean_luau_ioerr("Array element is not a number.");
+        }
+    }
+    return lean_io_result_mk_ok(values);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_checkArgs(lean_luau_State state, b_lean_obj_arg signature, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    const char* sig = lean_string_cstr(signature);
+    size_t len = lean_string_size(signature) - 1;
+    lean_object* args = lean_alloc_array(0, len);
+    int narg = 0;
+    for (size_t i = 0; i < len; ++i) {
+        int optional = sig[i] == '?';
+        if (optional && ++i == len) break;
+        ++narg;
+        int type = lua_type(L, narg);
+        if (optional && type <= LUA_TNIL) {
+            args = lean_array_push(args, lean_box(LEAN_LUAU_VALUE_NIL));
+            continue;
+        }
+        const char* expected = NULL;
+        switch (sig[i]) {
+            case 'n':
+            case 'i':
+                if (!lua_isnumber(L, narg)) expected = "number";
+                break;
+            case 'b':
+                if (type != LUA_TBOOLEAN) expected = "boolean";
+                break;
+            case 's':
+                if (type != LUA_TSTRING && type != LUA_TNUMBER) expected = "string";
+                break;
+            case 'B':
+                if (type != LUA_TBUFFER) expected = "buffer";
+                break;
+            case 'v':
+                if (type != LUA_TVECTOR) expected = "vector";
+                break;
+            case 'a':
+                if (type == LUA_TNONE) expected = "value";
+                break;
+            default:
+                lean_dec_ref(args);
+                return lean_luau_ioerr("Invalid function signature.");
+        }
+        if (expected != NULL) {
+            lean_dec_ref(args);
+            char msg[160];
+            lua_Debug ar;
+            if (lua_getinfo(L, 0, "n", &ar) && ar.name != NULL) {
+                snprintf(msg, sizeof(msg), "bad argument #%d to '%s' (%s expected, got %s)", narg, ar.name, expected, lua_typename(L, type));
+            }
+            else {
+                snprintf(msg, sizeof(msg), "bad argument #%d (%s expected, got %s)", narg, expected, lua_typename(L, type));
+            }
+            return lean_luau_ioerr(msg);
+        }
+        lean_object* v;
+        if (sig[i] == 'n' || sig[i] == 'i') {
+            // Numeric strings are converted like `luaL_checknumber` does
+            v = lean_alloc_ctor(LEAN_LUAU_VALUE_NUMBER, 0, sizeof(double));
+            lean_ctor_set_float(v, 0, sig[i] == 'i' ? (double)lua_tointeger(L, narg) : lua_tonumber(L, narg));
+        }
+        else {
+            if (sig[i] == 's') {
+                lua_tolstring(L, narg, NULL); // converts numbers in place
+            }
+            v = lean_luau_Value_read(L, narg, 0);
+        }
+        args = lean_array_push(args, v);
+    }
+    return lean_io_result_mk_ok(args);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_pushValues(lean_luau_State state, b_lean_obj_arg values, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    size_t n = lean_array_size(values);
+    if (n > LUAI_MAXCSTACK || !lua_checkstack(data->state, (int)n)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    for (size_t i = 0; i < n; ++i) {
+        lean_luau_Value_push(data->state, lean_array_get_core(values, i));
+    }
+    return lean_io_result_mk_ok(lean_box_uint32((uint32_t)n));
+}
+
+// Calls the function referenced by `ref` on one argument, leaves the result or the error message on the top.
+static int lean_luau_mapCall_one(lua_State* L, int ref) {
+    lua_getref(L, ref);
+    lua_insert(L, -2);
+    return lua_pcall(L, 1, 1, 0);
+}
+
+static lean_object* lean_luau_mapCall_message(lua_State* L) {
+    size_t len;
+    const char* msg = lua_tolstring(L, -1, &len);
+    return msg != NULL ? lean_mk_string_from_bytes(msg, len) : lean_mk_string("error object is not a string");
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_mapCall(lean_luau_State state, uint32_t ref, b_lean_obj_arg inputs, uint8_t refs, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    lean_luau_guard_valid(data);
+    lua_State* L = data->state;
+    if (!lua_checkstack(L, 3)) {
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    size_t n = lean_array_size(inputs);
+    lean_object* results = lean_alloc_array(n, n);
+    int top = lua_gettop(L);
+    for (size_t i = 0; i < n; ++i) {
+        lean_luau_Value_push(L, lean_array_get_core(inputs, i));
+        lean_object* res;
+        if (lean_luau_mapCall_one(L, (int32_t)ref) == LUA_OK) {
+            res = lean_alloc_ctor(1, 1, 0);
+            lean_ctor_set(res, 0, lean_luau_Value_read(L, -1, refs));
+        }
+        else {
+            res = lean_alloc_ctor(0, 1, 0);
+            lean_ctor_set(res, 0, lean_luau_mapCall_message(L));
+        }
+        lean_array_set_core(results, i, res);
+        lua_settop(L, top);
+    }
+    return lean_io_result_mk_ok(results);
+}
+
+LEAN_EXPORT lean_obj_res lean_luau_State_mapCallNumbers(lean_luau_State state, uint32_t ref, b_lean_obj_arg inputs, lean_obj_arg out, lean_obj_arg io_) {
+    lean_luau_State_data* data = lean_luau_State_fromRepr(state);
+    if (data->state == NULL || data->main->main == NULL) {
+        lean_dec_ref(out);
+        return lean_luau_ioerr("State is invalid (was closed).");
+    }
+    lua_State* L = data->state;
+    if (!lua_checkstack(L, 3)) {
+        lean_dec_ref(out);
+        return lean_luau_ioerr("Stack overflow.");
+    }
+    size_t n = lean_sarray_size(inputs);
+    // Results are written into `out` when it is not shared and large enough
+    if (!lean_is_exclusive(out) || lean_sarray_capacity(out) < n) {
+        lean_dec_ref(out);
+        out = lean_alloc_sarray(sizeof(double), n, n);
+    }
+    lean_to_sarray(out)->m_size = n;
+    const double* src = lean_float_array_cptr(inputs);
+    double* dst = lean_float_array_cptr(out);
+    lean_object* errors = lean_mk_empty_array();
+    int top = lua_gettop(L);
+    for (size_t i = 0; i < n; ++i) {
+        lua_pushnumber(L, src[i]);
+        int status = lean_luau_mapCall_one(L, (int32_t)ref);
+        if (status == LUA_OK && lua_type(L, -1) == LUA_TNUMBER) {
+            dst[i] = lua_tonumber(L, -1);
+        }
+        else {
+            dst[i] = NAN;
+            lean_object* err = status == LUA_OK ? lean_mk_string("result is not a number") : lean_luau_mapCall_message(L);
+            errors = lean_array_push(errors, lean_mk_tuple2(lean_usize_to_nat(i), err));
+        }
+        lua_settop(L, top);
+    }
+    return lean_io_result_mk_ok(lean_mk_tuple2(out, errors));
+}
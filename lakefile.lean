@@ -13,6 +13,38 @@ def optionLuauFlags := get_config? luau_flags |>.getD "" |> splitArgStr
 def optionLuauCCompiler := get_config? luau_cc |>.getD "cc"
 def optionLuauCppCompiler := get_config? luau_cxx |>.getD "clang++"
 def optionPrecompile := get_config? precompile |>.isSome
+/-- Link-time optimization of the VM together with the bindings (both compilers must emit compatible bitcode). -/
+def optionLTO := get_config? lto |>.isSome
+/-- `generate` to build an instrumented VM (see the `pgoTrain` script), `use` to optimize with `pgo_profile`. -/
+def optionPGO := get_config? pgo |>.getD ""
+def optionPGOProfile := get_config? pgo_profile |>.getD (__dir__ / "pgo" / "default.profdata").toString
+/-- `luaconf.h` overrides such as `LUAI_MAXCSTACK=16000`, applied to the VM and the bindings. -/
+def optionLuauDefines := get_config? luau_defines |>.getD "" |> splitArgStr
+
+def profileFlags : Array String :=
+  (if optionLTO then #["-flto=thin"] else #[]) ++
+  (match optionPGO with
+    | "generate" => #[s!"-fprofile-generate={__dir__ / "pgo"}"]
+    | "use" => #[s!"-fprofile-use={optionPGOProfile}"]
+    | _ => #[])
+
+def defineFlags : Array String :=
+  optionLuauDefines.map ("-D" ++ ·)
+
+/-- Constants mirrored by `Luau.Config`, passed to Lean as options. -/
+def configOptionNames : List (String × String) := [
+  ("LUAI_MAXCSTACK", "maxCStack"),
+  ("LUA_SIZECLASSES", "sizeClasses"),
+  ("LUA_MEMORY_CATEGORIES", "memoryCategories"),
+  ("LUA_VECTOR_SIZE", "vectorSize"),
+  ("LUA_UTAG_LIMIT", "utagLimit")
+]
+
+def configLeanArgs : Array String :=
+  optionLuauDefines.filterMap λ define ↦
+    match define.splitOn "=" with
+    | [name, value] => (configOptionNames.lookup name).map λ option ↦ s!"-Dweak.luau.{option}={value}"
+    | _ => none
 
 require pod from git "https://github.com/KislyjKisel/lean-pod" @ "adfbcd4"
 
@@ -20,17 +52,25 @@ package luau where
   srcDir := "src"
   leanOptions := #[⟨`autoImplicit, false⟩]
   precompileModules := optionPrecompile
+  moreLeanArgs := configLeanArgs
 
 @[default_target]
 lean_lib Luau where
 
+def exeLinkArgs : Array String :=
+  cond optionManual
+    #[]
+    (#[s!"-L{__dir__}/luau/build/", "-lLuau.VM", "-lLuau.Compiler", "-lLuau.Ast"] ++ profileFlags)
+
 @[test_driver]
 lean_exe «luau-test» where
   root := `Main
-  moreLinkArgs :=
-    cond optionManual
-      #[]
-      #[s!"-L{__dir__}/luau/build/", "-lLuau.VM", "-lLuau.Compiler", "-lLuau.Ast"]
+  moreLinkArgs := exeLinkArgs
+
+/-- Workload the `pgoTrain` script profiles. -/
+lean_exe «luau-bench» where
+  root := `Bench
+  moreLinkArgs := exeLinkArgs
 
 
 /-! # Submodule -/
@@ -57,8 +97,9 @@ def buildSubmodule' {m} [Monad m] [MonadError m] [MonadLiftT IO m] (printCmdOutp
       cmd := optionCMake
       args := #[
         s!"-DCMAKE_CXX_COMPILER={optionLuauCppCompiler}",
-        "-DCMAKE_CXX_FLAGS=-stdlib=libc++",
+        s!"-DCMAKE_CXX_FLAGS={" ".intercalate ("-stdlib=libc++" :: (profileFlags ++ defineFlags).toList)}",
         s!"-DCMAKE_C_COMPILER={optionLuauCCompiler}",
+        s!"-DCMAKE_C_FLAGS={" ".intercalate (profileFlags ++ defineFlags).toList}",
         "-DCMAKE_POSITION_INDEPENDENT_CODE=ON",
         "-DLUAU_EXTERN_C=ON",
         "-DLUAU_BUILD_CLI=OFF",
@@ -82,6 +123,32 @@ script buildSubmodule do
   buildSubmodule' true
   return 0
 
+/--
+Trains a PGO profile on the benchmark workload (`src/Bench.lean`): builds with `-Kpgo=generate`,
+runs `luau-bench` and merges the raw profiles into `pgo/default.profdata` for `-Kpgo=use`.
+Arguments: the `llvm-profdata` command and the number of rounds of the workload.
+-/
+script pgoTrain (args) do
+  let lake := (← IO.getEnv "LAKE").getD "lake"
+  let profdata := args.headD "llvm-profdata"
+  let rounds := (args.drop 1).headD "20"
+  let rawProfiles : IO (Array String) := do
+    if !(← (__dir__ / "pgo").pathExists) then
+      return #[]
+    (← (__dir__ / "pgo").readDir).filterMapM λ entry ↦
+      pure <| if entry.path.extension == some "profraw" then some entry.path.toString else none
+  -- Profiles of earlier runs would skew the merged one
+  for path in ← rawProfiles do
+    IO.FS.removeFile path
+  discard <| tryRunProcess { cmd := lake, args := #["-Kpgo=generate", "build", "luau-bench"], cwd := __dir__ }
+  discard <| tryRunProcess { cmd := lake, args := #["-Kpgo=generate", "exe", "luau-bench", rounds], cwd := __dir__ }
+  let raw ← rawProfiles
+  discard <| tryRunProcess {
+    cmd := profdata
+    args := #["merge", "-o", (__dir__ / "pgo" / "default.profdata").toString] ++ raw
+  }
+  return 0
+
 
 /-! # Bindings -/
 
@@ -89,13 +156,25 @@ def bindingsSources := #[
   "initialization",
   "config",
   "compile",
-  "core"
+  "core",
+  "unsafe",
+  "transfer",
+  "serialize",
+  "json",
+  "value",
+  "bundle",
+  "instrumentation",
+  "allocprof",
+  "threadstats",
+  "proxy",
+  "fields",
+  "errors"
 ]
 
 extern_lib «luau-lean» pkg := do
   let name := nameToStaticLib "luau-lean"
   let mut weakArgs := #["-I", (← getLeanIncludeDir).toString]
-  let mut traceArgs := optionBindingsCompilerFlags.append #[
+  let mut traceArgs := optionBindingsCompilerFlags ++ profileFlags ++ defineFlags ++ #[
     "-fPIC",
     "-I", (pkg.dir / "ffi" / "include").toString
   ]
@@ -0,0 +1,77 @@
+import Luau
+import Luau.Extra
+
+/-!
+Workload used to train PGO profiles (see the `pgoTrain` script):
+compilation, table operations, Luau and host calls, and garbage collection.
+-/
+
+open Luau
+
+abbrev BenchState := State Unit (λ _ ↦ Unit) (λ _ ↦ Unit)
+
+/-- Source with many small functions, for the compiler. -/
+def generated (n : Nat) : String := String.join <| (List.range n).map λ i ↦
+  s!"local function f{i}(a, b)\n" ++
+  s!"  local t = \{ a, b, a + b, name = \"f{i}\" }\n" ++
+  s!"  if t[3] > {i} then return t[1] * {i} else return t.name .. tostring(t[2]) end\n" ++
+  "end\n"
+
+def workload := "
+local n = ...
+
+local function fib(k)
+  if k < 2 then return k end
+  return fib(k - 1) + fib(k - 2)
+end
+
+local function tables(k)
+  local t = {}
+  for i = 1, k do t[i] = (i * 7919) % k end
+  local h = {}
+  for i = 1, k do
+    local key = \"k\" .. (i % 512)
+    h[key] = (h[key] or 0) + t[i]
+  end
+  table.sort(t, function(a, b) return a > b end)
+  local s = 0
+  for _, v in h do s += v end
+  return #t + s
+end
+
+local function garbage(k)
+  local keep = {}
+  for i = 1, k do
+    local o = { i, tostring(i), { x = i, y = i * 2 } }
+    if i % 64 == 0 then table.insert(keep, o) end
+  end
+  return #keep
+end
+
+local function host(k)
+  local s = 0
+  for i = 1, k do s = hostAdd(s, i) end
+  return s
+end
+
+return fib(22) + tables(n) + garbage(n) + host(n // 4)
+"
+
+def main (args : List String) : IO Unit := do
+  let rounds := (args.head? >>= String.toNat?).getD 20
+  let source := generated 300
+  for _ in [0:rounds] do
+    discard <| Luau.compile source (.ofRaw {})
+  let (.mk _ code) ← Luau.compile workload (.ofRaw {})
+  let state : BenchState ← State.new
+  state.openLibs
+  state.pushCFunction (λ s ↦ do
+    s.pushNumber ((← s.checkNumber 1) + (← s.checkNumber 2))
+    pure 1) "hostAdd"
+  state.setGlobal "hostAdd"
+  for _ in [0:rounds] do
+    state.tryLoad "=bench" code.view
+    state.pushNumber 20000
+    state.call 1 1
+    state.pop 1
+  state.close
@@ -3,3 +3,12 @@ import Luau.Config
 import Luau.Compile
 import Luau.Core
 import Luau.Lib
+import Luau.Value
+import Luau.Proxy
+import Luau.Fields
+import Luau.HostError
+import Luau.Bundle
+import Luau.Instrumentation
+import Luau.AllocProfile
+import Luau.ThreadStats
+import Luau.Unsafe
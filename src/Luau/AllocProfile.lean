@@ -0,0 +1,55 @@
+import Luau.Core
+
+namespace Luau
+
+/-- Sampled allocations attributed to one Luau call stack. -/
+structure AllocSite where
+  /-- Frames separated by `;`, outermost first, each as `name source:line`. -/
+  stack : String
+  /-- Estimated bytes: every sample stands for `sampleBytes` bytes. -/
+  bytes : UInt64
+  samples : UInt64
+deriving Inhabited, Repr
+
+structure AllocProfile where
+  sites : Array AllocSite
+  /-- All bytes allocated while profiling, sampled or not. -/
+  totalBytes : UInt64
+deriving Inhabited, Repr
+
+namespace AllocProfile
+
+/-- Folded stacks (`stack bytes` per line), the input format of flame graph tools. -/
+def toFolded (profile : AllocProfile) : String :=
+  profile.sites.foldl (λ acc site ↦ acc ++ s!"{site.stack} {site.bytes}\n") ""
+
+/-- Sites sorted by decreasing bytes. -/
+def top (profile : AllocProfile) (n : Nat := 20) : Array AllocSite :=
+  (profile.sites.qsort (·.bytes > ·.bytes)).extract 0 n
+
+end AllocProfile
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Starts sampling allocations of the whole state, threads included.
+Every `sampleBytes` allocated bytes a sample is taken, and the stack (at most `maxDepth` frames)
+is recorded at the next VM interrupt, i.e. the next call or loop iteration.
+Uses the `onallocate` and interrupt callbacks, so only one sampler can be active per state.
+-/
+@[extern "lean_luau_State_startAllocProfile"]
+opaque startAllocProfile (state : @& State Uu Ut Lt) (sampleBytes : USize := 512 * 1024) (maxDepth : UInt32 := 64) : IO Unit
+
+/-- Stops sampling, the collected profile is kept. -/
+@[extern "lean_luau_State_stopAllocProfile"]
+opaque stopAllocProfile (state : @& State Uu Ut Lt) : IO Unit
+
+@[extern "lean_luau_State_allocProfile"]
+opaque allocProfile (state : @& State Uu Ut Lt) : IO AllocProfile
+
+@[extern "lean_luau_State_resetAllocProfile"]
+opaque resetAllocProfile (state : @& State Uu Ut Lt) : IO Unit
+
+end State
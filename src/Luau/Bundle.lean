@@ -0,0 +1,131 @@
+import Luau.Compile
+import Luau.Core
+
+namespace Luau
+
+open scoped Pod
+open Pod (BytesView)
+
+/-- Copies the viewed bytes into a byte array. -/
+@[extern "lean_luau_copyBytes"]
+opaque copyBytes {size : @& Nat} (view : @& BytesView size 1) : ByteArray
+
+/--
+A memory-mapped file with bytecode of many chunks, created by `Bundle.write`.
+Chunks are loaded straight from the mapping and checked against their checksum on first use.
+-/
+define_foreign_type Bundle
+
+namespace Bundle
+
+-- Layout synchronized with FFI
+def magic : String := "LUAUBNDL"
+def version : UInt32 := 1
+def headerSize : Nat := 32
+def entrySize : Nat := 32
+
+/-- 64-bit FNV-1a hash. -/
+def fnv1a (data : ByteArray) (start : Nat := 0) (stop : Nat := data.size) : UInt64 := Id.run do
+  let mut h : UInt64 := 0xcbf29ce484222325
+  for i in [start:stop] do
+    h := (h ^^^ data[i]!.toUInt64) * 0x100000001b3
+  h
+
+/-- Identifies compile options, bundles record the fingerprint of the options they were compiled with. -/
+def fingerprintOf (options : CompileOptions) : UInt64 :=
+  fnv1a (reprStr options).toUTF8
+
+private def pushU32 (b : ByteArray) (x : UInt32) : ByteArray :=
+  (b.push x.toUInt8).push (x >>> 8).toUInt8 |>.push (x >>> 16).toUInt8 |>.push (x >>> 24).toUInt8
+
+private def pushU64 (b : ByteArray) (x : UInt64) : ByteArray :=
+  pushU32 (pushU32 b x.toUInt32) (x >>> 32).toUInt32
+
+private def setU64 (b : ByteArray) (offset : Nat) (x : UInt64) : ByteArray := Id.run do
+  let mut b := b
+  for i in [0:8] do
+    b := b.set! (offset + i) (x >>> (8 * i).toUInt64).toUInt8
+  b
+
+/--
+Compiles the chunks `(name, source)` and writes them into a single bundle file.
+Fails without writing anything if a chunk doesn't compile or a name is repeated.
+-/
+def write (path : System.FilePath) (chunks : Array (String × String)) (options : CompileOptions := {}) : IO Unit := do
+  let baked := options.bake
+  let compiled ← chunks.mapM λ (name, source) ↦ do
+    let ⟨_, bytecode⟩ ← Luau.compile source baked
+    let bytes := copyBytes bytecode.view
+    if bytes.size == 0 || bytes[0]! == 0 then
+      let msg := (String.fromUTF8? (bytes.extract 1 bytes.size)).getD "invalid error message"
+      throw <| IO.userError s!"Failed to compile '{name}': {msg}"
+    pure (name, bytes)
+  let compiled := compiled.qsort (·.1 < ·.1)
+  for i in [1:compiled.size] do
+    if compiled[i]!.1 == compiled[i - 1]!.1 then
+      throw <| IO.userError s!"Chunk name '{compiled[i]!.1}' is repeated."
+  let namesStart := headerSize + entrySize * compiled.size
+  let namesSize := compiled.foldl (· + ·.1.utf8ByteSize) 0
+  -- Bytecode is 8-byte aligned
+  let dataStart := (namesStart + namesSize + 7) / 8 * 8
+  let mut out := ByteArray.mkEmpty (dataStart + compiled.foldl (· + ·.2.size + 7) 0)
+  out := out ++ magic.toUTF8
+  out := pushU32 out version
+  out := pushU32 out compiled.size.toUInt32
+  out := pushU64 out (fingerprintOf options)
+  out := pushU64 out 0 -- index checksum
+  let mut nameOffset := namesStart
+  let mut dataOffset := dataStart
+  for (name, bytes) in compiled do
+    out := pushU32 out nameOffset.toUInt32
+    out := pushU32 out name.utf8ByteSize.toUInt32
+    out := pushU64 out dataOffset.toUInt64
+    out := pushU64 out bytes.size.toUInt64
+    out := pushU64 out (fnv1a bytes)
+    nameOffset := nameOffset + name.utf8ByteSize
+    dataOffset := (dataOffset + bytes.size + 7) / 8 * 8
+  for (name, _) in compiled do
+    out := out ++ name.toUTF8
+  out := setU64 out 24 (fnv1a out headerSize out.size)
+  for (_, bytes) in compiled do
+    while out.size % 8 != 0 do
+      out := out.push 0
+    out := out ++ bytes
+  IO.FS.writeBinFile path out
+
+/-- Maps a bundle file into memory and validates its header and index. -/
+@[extern "lean_luau_Bundle_openFile"]
+opaque openFile (path : @& String) : IO Bundle
+
+/-- Fingerprint of the compile options the bundle was created with (see `fingerprintOf`). -/
+@[extern "lean_luau_Bundle_fingerprint"]
+opaque fingerprint (bundle : @& Bundle) : UInt64
+
+/-- Names of the bundled chunks, in sorted order. -/
+@[extern "lean_luau_Bundle_names"]
+opaque names (bundle : @& Bundle) : Array String
+
+@[extern "lean_luau_Bundle_contains"]
+opaque contains (bundle : @& Bundle) (name : @& String) : Bool
+
+/-- Same as `openFile`, but fails if the bundle was compiled with different options. -/
+def openChecked (path : System.FilePath) (options : CompileOptions) : IO Bundle := do
+  let bundle ← openFile path.toString
+  if bundle.fingerprint != fingerprintOf options then
+    throw <| IO.userError s!"Bundle '{path}' was compiled with different options."
+  pure bundle
+
+end Bundle
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Loads the bundled chunk `name` like `load`, reading the bytecode directly from the mapped file.
+Fails if there is no such chunk or its checksum doesn't match.
+-/
+@[extern "lean_luau_State_loadBundled"]
+opaque loadBundled (state : @& State Uu Ut Lt) (bundle : @& Bundle) (name : @& String) (chunkName : @& String := "@" ++ name) (env : Int32 := 0) : IO Bool
+
+end State
@@ -92,3 +92,25 @@ When source compilation fails, the resulting bytecode contains the encoded error
 @[extern "lean_luau_compile"]
 opaque compile (source : @& String) (options : @& CompileOptions') : BaseIO (Σ size : Nat, Buffer size 1) :=
   pure (.mk 0 Classical.ofNonempty)
+
+/-- Error reported by the compiler. Luau doesn't encode the column of the error. -/
+structure CompileError where
+  /-- 1-based line of the error, `0` if unknown. -/
+  line : Nat
+  message : String
+deriving Repr, Inhabited
+
+instance : ToString CompileError where
+  toString e := s!":{e.line}: {e.message}"
+
+/--
+Compile source to bytecode.
+Compilation errors are decoded from the resulting bytecode, so it never has to be loaded to detect them.
+-/
+@[extern "lean_luau_compileChecked"]
+opaque compileChecked (source : @& String) (options : @& CompileOptions') : BaseIO (Except CompileError (Σ size : Nat, Buffer size 1))
+
+/-- Compiles the sources in parallel tasks, the results are in the order of the sources. -/
+def compileCheckedBatch (sources : Array String) (options : CompileOptions') : BaseIO (Array (Except CompileError (Σ size : Nat, Buffer size 1))) := do
+  let tasks ← sources.mapM λ source ↦ BaseIO.asTask (compileChecked source options)
+  pure <| tasks.map Task.get
@@ -1,4 +1,5 @@
 import Pod.Meta
+import Luau.Config.Options
 
 namespace Luau.Config
 
@@ -8,7 +9,8 @@ def useLongjmp := true -- implied by the usage of C API
 
 define_foreign_constant idSize : UInt32 := "lean_luau_config_idSize"
 
-define_foreign_constant maxCStack : UInt32 := "lean_luau_config_maxCStack"
+/-- Can be set from Lake, see `verify`. -/
+def maxCStack : UInt32 := luau_config% luau.maxCStack
 
 define_foreign_constant maxCalls : UInt32 := "lean_luau_config_maxCalls"
 
@@ -16,17 +18,43 @@ define_foreign_constant maxCCalls : UInt32 := "lean_luau_config_maxCCalls"
 
 define_foreign_constant bufferSize : UInt32 := "lean_luau_config_bufferSize"
 
--- TODO: specify from Lake
-def utagLimit : UInt32 := 128
+/-- Can be set from Lake, see `verify`. -/
+def utagLimit : UInt32 := luau_config% luau.utagLimit
 
-define_foreign_constant sizeClasses : UInt32 := "lean_luau_config_sizeClasses"
+/-- Can be set from Lake, see `verify`. -/
+def sizeClasses : UInt32 := luau_config% luau.sizeClasses
 
-define_foreign_constant memoryCategories : UInt32 := "lean_luau_config_memoryCategories"
+/-- Can be set from Lake, see `verify`. -/
+def memoryCategories : UInt32 := luau_config% luau.memoryCategories
 
 define_foreign_constant minStrTabSize : UInt32 := "lean_luau_config_minStrTabSize"
 
 define_foreign_constant maxCaptures : UInt32 := "lean_luau_config_maxCaptures"
 
-define_foreign_constant vectorSize : UInt32 := "lean_luau_config_vectorSize"
+/-- Can be set from Lake, see `verify`. -/
+def vectorSize : UInt32 := luau_config% luau.vectorSize
 
 define_foreign_constant extraSize : UInt32 := "lean_luau_config_extraSize"
+
+define_foreign_constant nativeMaxCStack : UInt32 := "lean_luau_config_maxCStack"
+
+define_foreign_constant nativeUtagLimit : UInt32 := "lean_luau_config_utagLimit"
+
+define_foreign_constant nativeSizeClasses : UInt32 := "lean_luau_config_sizeClasses"
+
+define_foreign_constant nativeMemoryCategories : UInt32 := "lean_luau_config_memoryCategories"
+
+define_foreign_constant nativeVectorSize : UInt32 := "lean_luau_config_vectorSize"
+
+/-- Fails if the compile-time values differ from the ones the bindings were compiled with. -/
+def verify : IO Unit := do
+  let pairs := #[
+    ("maxCStack", maxCStack, nativeMaxCStack),
+    ("utagLimit", utagLimit, nativeUtagLimit),
+    ("sizeClasses", sizeClasses, nativeSizeClasses),
+    ("memoryCategories", memoryCategories, nativeMemoryCategories),
+    ("vectorSize", vectorSize, nativeVectorSize)
+  ]
+  for (name, value, native) in pairs do
+    if value != native then
+      throw <| IO.userError s!"Config.{name} is {value}, but the bindings were built with {native}."
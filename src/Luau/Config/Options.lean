@@ -0,0 +1,46 @@
+import Lean.Elab.Term
+
+/-!
+Compile-time values of the `luaconf.h` constants which can be overridden from Lake (`-Kluau_defines=...`).
+The lakefile passes them as `weak.luau.*` options, the defaults are the ones of `luaconf.h`.
+-/
+
+namespace Luau.Config
+
+register_option luau.maxCStack : Nat := {
+  defValue := 8000
+  descr := "LUAI_MAXCSTACK the VM is built with"
+}
+
+register_option luau.sizeClasses : Nat := {
+  defValue := 40
+  descr := "LUA_SIZECLASSES the VM is built with"
+}
+
+register_option luau.memoryCategories : Nat := {
+  defValue := 256
+  descr := "LUA_MEMORY_CATEGORIES the VM is built with"
+}
+
+register_option luau.vectorSize : Nat := {
+  defValue := 3
+  descr := "LUA_VECTOR_SIZE the VM is built with"
+}
+
+register_option luau.utagLimit : Nat := {
+  defValue := 128
+  descr := "LUA_UTAG_LIMIT the VM is built with"
+}
+
+open Lean Elab Term in
+/-- The value of a numeric option registered above, as a literal. -/
+elab "luau_config% " opt:ident : term <= expectedType => do
+  let name := opt.getId
+  let some decl := (← getOptionDecls).find? name
+    | throwErrorAt opt "Unknown option '{name}'."
+  let .ofNat default := decl.defValue
+    | throwErrorAt opt "Option '{name}' is not numeric."
+  let value := (← getOptions).getNat name default
+  elabTerm (Syntax.mkNumLit (toString value)) expectedType
+
+end Luau.Config
@@ -64,6 +64,15 @@ def CFunction (Uu : Type) (Ut Lt : Tag → Type) := State Uu Ut Lt → IO Int32
 /-- NOTE: User upvalues start at index 2. -/
 def Continuation (Uu : Type) (Ut Lt : Tag → Type) := State Uu Ut Lt → CoStatus → IO Int32
 
+/--
+Address of a native `lua_CFunction`, usually returned as `size_t` by an `@[extern]` C function.
+Raw functions are called by the VM directly, without going through a Lean closure.
+Unlike `CFunction`, user upvalues start at index 1.
+-/
+structure RawCFunction where
+  ptr : USize
+deriving Inhabited, BEq
+
 -- Alloc skipped
 
 def tNone : Int32 := -1
@@ -123,6 +132,13 @@ opaque mainThread (state : @& State Uu Ut Lt) : IO (State Uu Ut Lt)
 @[extern "lean_luau_State_resetThread"]
 opaque resetThread (state : @& State Uu Ut Lt) : IO Unit
 
+/--
+Same as `resetThread`, but the thread stays valid and can run new code.
+The caller must keep the thread referenced (e.g. with `ref`) for it to stay alive.
+-/
+@[extern "lean_luau_State_recycleThread"]
+opaque recycleThread (state : @& State Uu Ut Lt) : IO Unit
+
 @[extern "lean_luau_State_isThreadReset"]
 opaque isThreadReset (state : @& State Uu Ut Lt) : IO Bool
 
@@ -203,6 +219,33 @@ opaque xmove («from» to : @& State Uu Ut Lt) (n : Int32) : IO Unit
 @[extern "lean_luau_State_xpush"]
 opaque xpush («from» to : @& State Uu Ut Lt) (idx : Int32) : IO Unit
 
+/--
+Pushes onto `dst` a deep copy of the value at `idx` in `src`. The states may be unrelated.
+
+Supports nil, booleans, numbers, vectors, strings, buffers, tables, plain-data userdata and
+userdata created by `newUserdata`/`newUserdataTagged` (the Lean object is shared).
+Userdata created by `newUserdataDtor` are rejected, as their destructor would run once per copy.
+Shared and cyclic table references are preserved; table metatables are not copied,
+userdata get the metatable registered for their tag in `dst`.
+
+`maxDepth` limits table nesting and `maxBytes` limits the approximate size of the copied data.
+On failure nothing is pushed.
+-/
+@[extern "lean_luau_State_copyValue"]
+opaque copyValue (src : @& State Uu Ut Lt) (idx : Int32) (dst : @& State Uu Ut Lt) (maxDepth : UInt32 := 200) (maxBytes : USize := 0x10000000) : IO Unit
+
+/--
+Serializes the value at index `idx` into a compact binary format.
+Supports nil, booleans, numbers, strings, buffers, vectors and tables of those (without cycles).
+The contents of `out` are replaced, its storage is reused when it isn't shared.
+-/
+@[extern "lean_luau_State_encode"]
+opaque encode (state : @& State Uu Ut Lt) (idx : Int32) (out : ByteArray := .empty) (maxDepth : UInt32 := 200) (maxBytes : USize := 0x10000000) : IO ByteArray
+
+/-- Pushes onto the stack the value serialized by `encode`. Tables are created presized. -/
+@[extern "lean_luau_State_decode"]
+opaque decode (state : @& State Uu Ut Lt) (bytes : @& ByteArray) (maxDepth : UInt32 := 200) : IO Unit
+
 
 /-! # Access functions -/
 
@@ -369,6 +412,13 @@ def strLen (state : State Uu Ut Lt) (idx : Int32) : IO Int32 :=
 @[extern "lean_luau_State_toCFunction"]
 opaque toCFunction (state : @& State Uu Ut Lt) (idx : Int32) : IO (Option (CFunction Uu Ut Lt))
 
+/--
+Address of the native function at the given index,
+`none` if it isn't a C function or is a Lean `CFunction` (these share a single trampoline).
+-/
+@[extern "lean_luau_State_toRawCFunction"]
+opaque toRawCFunction (state : @& State Uu Ut Lt) (idx : Int32) : IO (Option RawCFunction)
+
 -- TODO: toLightUserdata (?)
 
 @[extern "lean_luau_State_toLightUserdataTagged"]
@@ -436,6 +486,17 @@ NOTE: User upvalues start at index 2. `nup` is the number of *user* upvalues.
 def pushCFunction (state : State Uu Ut Lt) (fn : CFunction Uu Ut Lt) (debugName : Option String) : IO Unit :=
   pushCClosure state fn debugName 0
 
+/--
+Pushes a native function without wrapping it in a Lean closure.
+`nup` is the number of upvalues, which start at index 1.
+-/
+@[extern "lean_luau_State_pushRawCClosure"]
+opaque pushRawCClosure (state : @& State Uu Ut Lt) (fn : RawCFunction) (debugName : @& Option String) (nup : UInt32) : IO Unit
+
+@[inline]
+def pushRawCFunction (state : State Uu Ut Lt) (fn : RawCFunction) (debugName : Option String) : IO Unit :=
+  pushRawCClosure state fn debugName 0
+
 @[extern "lean_luau_State_pushBoolean"]
 opaque pushBoolean (state : @& State Uu Ut Lt) (b : Bool) : IO Unit
 
@@ -447,6 +508,7 @@ opaque pushLightUserdataTagged (state : @& State Uu Ut Lt) (tag : Tag) (p : Lt t
 
 -- TODO; pushLightUserdata (?)
 
+/-- Fails if the tag was used by plain-data userdata (`newUserdataPod`). -/
 @[extern "lean_luau_State_newUserdataTagged"]
 opaque newUserdataTagged (state : @& State Uu Ut Lt) (tag : Tag) (userdata : Ut tag) : IO Unit
 
@@ -460,9 +522,73 @@ opaque newUserdata (state : @& State Uu Ut Lt) (userdata : Uu) : IO Unit
 @[extern "lean_luau_State_newUserdataDtor"]
 opaque newUserdataDtor (state : @& State Uu Ut Lt) (userdata : Uu) (dtor : Uu → BaseIO Unit) : IO Unit
 
+/--
+Declares the memory held by the Lean object of the userdata at `idx`
+(created by `newUserdata`/`newUserdataDtor`/`newUserdataTagged`), which Luau's GC can't see.
+Growth is paid for with collection steps, as if Luau had allocated it.
+The size is released when the userdata is collected.
+-/
+@[extern "lean_luau_State_setExternalSize"]
+opaque setExternalSize (state : @& State Uu Ut Lt) (idx : Int32) (size : USize) : IO Unit
+
+/-- Total size declared with `setExternalSize` by the userdata still alive. -/
+@[extern "lean_luau_State_externalBytes"]
+opaque externalBytes (state : @& State Uu Ut Lt) : IO USize
+
 @[extern "lean_luau_State_newBuffer"]
 opaque newBuffer (state : @& State Uu Ut Lt) {sz : @& Nat} (data : @& BytesView sz 1) : IO Unit
 
+/--
+Creates a tagged userdata storing a copy of `data` inline in the Luau allocation.
+No Lean object is referenced and no destructor runs when the userdata is collected.
+The tag must be reserved for plain-data userdata, i.e. not used with `newUserdataTagged`.
+-/
+@[extern "lean_luau_State_newUserdataPod"]
+opaque newUserdataPod (state : @& State Uu Ut Lt) (tag : Tag) {sz : @& Nat} (data : @& BytesView sz 1) : IO Unit
+
+/-- Faster creation of plain-data userdata with metatables registered with `setUserdataMetatable`. -/
+@[extern "lean_luau_State_newUserdataPodWithMetatable"]
+opaque newUserdataPodWithMetatable (state : @& State Uu Ut Lt) (tag : Tag) {sz : @& Nat} (data : @& BytesView sz 1) : IO Unit
+
+/-- Copies the bytes of the plain-data userdata with the given tag. -/
+@[extern "lean_luau_State_toUserdataPod"]
+opaque toUserdataPod (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) : IO (Option ByteArray)
+
+/-!
+Typed access to fields of plain-data userdata at byte offsets, without copying the whole value.
+Throws if the value is not a userdata with the given tag or the field is out of bounds.
+-/
+
+@[extern "lean_luau_State_podGetUInt8"]
+opaque podGetUInt8 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) : IO UInt8
+
+@[extern "lean_luau_State_podGetUInt16"]
+opaque podGetUInt16 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) : IO UInt16
+
+@[extern "lean_luau_State_podGetUInt32"]
+opaque podGetUInt32 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) : IO UInt32
+
+@[extern "lean_luau_State_podGetUInt64"]
+opaque podGetUInt64 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) : IO UInt64
+
+@[extern "lean_luau_State_podGetFloat"]
+opaque podGetFloat (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) : IO Float
+
+@[extern "lean_luau_State_podSetUInt8"]
+opaque podSetUInt8 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) (val : UInt8) : IO Unit
+
+@[extern "lean_luau_State_podSetUInt16"]
+opaque podSetUInt16 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) (val : UInt16) : IO Unit
+
+@[extern "lean_luau_State_podSetUInt32"]
+opaque podSetUInt32 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) (val : UInt32) : IO Unit
+
+@[extern "lean_luau_State_podSetUInt64"]
+opaque podSetUInt64 (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) (val : UInt64) : IO Unit
+
+@[extern "lean_luau_State_podSetFloat"]
+opaque podSetFloat (state : @& State Uu Ut Lt) (idx : Int32) (tag : Tag) (offset : USize) (val : Float) : IO Unit
+
 
 /-! # Get functions (Lua -> stack) -/
 
@@ -754,6 +880,29 @@ opaque setUserdataDtor (state : @& State Uu Ut Lt) (tag : Tag) (dtor : State Uu
 @[extern "lean_luau_State_resetUserdataDtor"]
 opaque resetUserdataDtor (state : @& State Uu Ut Lt) (tag : Tag) : IO Unit
 
+/--
+When enabled, tagged userdata with the given tag are not destroyed during the GC sweep.
+Instead their Lean objects are enqueued into a native buffer, to be taken with `drainUserdataQueue`.
+Takes precedence over the destructor set with `setUserdataDtor`.
+-/
+@[extern "lean_luau_State_setUserdataQueued"]
+opaque setUserdataQueued (state : @& State Uu Ut Lt) (tag : Tag) (enabled : Bool) : IO Unit
+
+/--
+Same as `setUserdataQueued` but for untagged userdata created without a destructor closure.
+The objects are taken with `drainUntaggedUserdataQueue`.
+-/
+@[extern "lean_luau_State_setUntaggedUserdataQueued"]
+opaque setUntaggedUserdataQueued (state : @& State Uu Ut Lt) (enabled : Bool) : IO Unit
+
+/-- Takes all userdata with the given tag enqueued since the last call. -/
+@[extern "lean_luau_State_drainUserdataQueue"]
+opaque drainUserdataQueue (state : @& State Uu Ut Lt) (tag : Tag) : IO (Array (Ut tag))
+
+/-- Takes all untagged userdata enqueued since the last call. -/
+@[extern "lean_luau_State_drainUntaggedUserdataQueue"]
+opaque drainUntaggedUserdataQueue (state : @& State Uu Ut Lt) : IO (Array Uu)
+
 @[extern "lean_luau_State_setUserdataMetatable"]
 opaque setUserdataMetatable (state : @& State Uu Ut Lt) (tag : Tag) (idx : Int32) : IO Unit
 
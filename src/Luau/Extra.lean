@@ -1,2 +1,7 @@
 import Luau.Extra.FromTo
 import Luau.Extra.Eval
+import Luau.Extra.PodUserdata
+import Luau.Extra.Modules
+import Luau.Extra.BytecodeStats
+import Luau.Extra.LuaFn
+import Luau.Extra.ThreadPool
@@ -0,0 +1,311 @@
+import Luau.Bundle
+
+/-!
+Reader of the bytecode produced by `Luau.compile`, reporting per-function statistics.
+The opcode table follows `Common/include/Luau/Bytecode.h` of the bundled Luau.
+-/
+
+namespace Luau.Bytecode
+
+/-- Opcode names, indexed by opcode. -/
+def opcodeNames : Array String := #[
+  "NOP", "BREAK", "LOADNIL", "LOADB", "LOADN", "LOADK", "MOVE", "GETGLOBAL",
+  "SETGLOBAL", "GETUPVAL", "SETUPVAL", "CLOSEUPVALS", "GETIMPORT", "GETTABLE", "SETTABLE", "GETTABLEKS",
+  "SETTABLEKS", "GETTABLEN", "SETTABLEN", "NEWCLOSURE", "NAMECALL", "CALL", "RETURN", "JUMP",
+  "JUMPBACK", "JUMPIF", "JUMPIFNOT", "JUMPIFEQ", "JUMPIFLE", "JUMPIFLT", "JUMPIFNOTEQ", "JUMPIFNOTLE",
+  "JUMPIFNOTLT", "ADD", "SUB", "MUL", "DIV", "MOD", "POW", "ADDK",
+  "SUBK", "MULK", "DIVK", "MODK", "POWK", "AND", "OR", "ANDK",
+  "ORK", "CONCAT", "NOT", "MINUS", "LENGTH", "NEWTABLE", "DUPTABLE", "SETLIST",
+  "FORNPREP", "FORNLOOP", "FORGLOOP", "FORGPREP_INEXT", "FASTCALL3", "FORGPREP_NEXT", "NATIVECALL", "GETVARARGS",
+  "DUPCLOSURE", "PREPVARARGS", "LOADKX", "JUMPX", "FASTCALL", "COVERAGE", "CAPTURE", "SUBRK",
+  "DIVRK", "FASTCALL1", "FASTCALL2", "FASTCALL2K", "FORGPREP", "JUMPXEQKNIL", "JUMPXEQKB", "JUMPXEQKN",
+  "JUMPXEQKS", "IDIV", "IDIVK"
+]
+
+def opGetGlobal : Nat := 7
+def opSetGlobal : Nat := 8
+def opGetImport : Nat := 12
+def opFastcall3 : Nat := 60
+def opFastcall : Nat := 68
+def opFastcall1 : Nat := 73
+def opFastcall2 : Nat := 74
+def opFastcall2K : Nat := 75
+
+/-- Whether the instruction is followed by an auxiliary word. -/
+def hasAux (op : Nat) : Bool :=
+  op ∈ [7, 8, 12, 15, 16, 20, 27, 28, 29, 30, 31, 32, 53, 55, 58, 60, 66, 74, 75, 77, 78, 79, 80]
+
+def isFastcall (op : Nat) : Bool :=
+  op == opFastcall || op == opFastcall1 || op == opFastcall2 || op == opFastcall2K || op == opFastcall3
+
+structure Function where
+  name : Option String
+  lineDefined : Nat
+  maxStackSize : Nat
+  numParams : Nat
+  numUpvalues : Nat
+  isVararg : Bool
+  /-- Number of instructions, not counting auxiliary words. -/
+  instructions : Nat
+  /-- Size of the code in 32-bit words. -/
+  codeWords : Nat
+  constants : Nat
+  /-- Instruction counts indexed by opcode. -/
+  opcodes : Array Nat
+  /-- Fastcall counts indexed by builtin function id. -/
+  builtins : Array Nat
+  /-- Indices of the functions defined inside this one. -/
+  children : Array Nat
+deriving Repr, Inhabited
+
+namespace Function
+
+def opcodeCount (f : Function) (op : Nat) : Nat := f.opcodes.getD op 0
+
+def fastcalls (f : Function) : Nat := f.builtins.foldl (· + ·) 0
+
+/--
+Global accesses that weren't turned into imports.
+The import optimization is disabled for globals listed in `mutableGlobals` or when the chunk assigns globals.
+-/
+def globalAccesses (f : Function) : Nat := f.opcodeCount opGetGlobal + f.opcodeCount opSetGlobal
+
+def imports (f : Function) : Nat := f.opcodeCount opGetImport
+
+def label (f : Function) : String := s!"{f.name.getD "<anonymous>"}:{f.lineDefined}"
+
+end Function
+
+structure Chunk where
+  version : Nat
+  strings : Array String
+  functions : Array Function
+  main : Nat
+deriving Repr, Inhabited
+
+private structure Cursor where
+  data : ByteArray
+  pos : Nat
+
+private abbrev Parser := StateT Cursor (Except String)
+
+private def u8 : Parser Nat := do
+  let c ← get
+  if h : c.pos < c.data.size then
+    set { c with pos := c.pos + 1 }
+    pure c.data[c.pos].toNat
+  else
+    throw "Unexpected end of bytecode."
+
+private def u32 : Parser Nat := do
+  let b0 ← u8
+  let b1 ← u8
+  let b2 ← u8
+  let b3 ← u8
+  pure (b0 ||| (b1 <<< 8) ||| (b2 <<< 16) ||| (b3 <<< 24))
+
+private def varint : Parser Nat := do
+  let mut res := 0
+  for i in [0:5] do
+    let b ← u8
+    res := res ||| ((b &&& 0x7F) <<< (7 * i))
+    if b &&& 0x80 == 0 then
+      return res
+  throw "Malformed variable-length integer."
+
+private def skip (n : Nat) : Parser Unit := do
+  let c ← get
+  if c.pos + n ≤ c.data.size then
+    set { c with pos := c.pos + n }
+  else
+    throw "Unexpected end of bytecode."
+
+private def string : Parser String := do
+  let len ← varint
+  let c ← get
+  skip len
+  pure <| (String.fromUTF8? (c.data.extract c.pos (c.pos + len))).getD ""
+
+private def constant : Parser Unit := do
+  match ← u8 with
+  | 0 => pure () -- nil
+  | 1 => skip 1 -- boolean
+  | 2 => skip 8 -- number
+  | 3 => discard varint -- string
+  | 4 => skip 4 -- import
+  | 5 => -- table
+    for _ in [0:(← varint)] do
+      discard varint
+  | 6 => discard varint -- closure
+  | 7 => skip 16 -- vector
+  | 8 => -- table with constants
+    for _ in [0:(← varint)] do
+      discard varint
+      skip 4
+  | k => throw s!"Unknown constant kind {k}."
+
+private def function (version : Nat) (strings : Array String) : Parser Function := do
+  let maxStackSize ← u8
+  let numParams ← u8
+  let numUpvalues ← u8
+  let isVararg := (← u8) != 0
+  if version ≥ 4 then
+    discard u8 -- flags
+    skip (← varint) -- type info
+  let codeWords ← varint
+  let mut opcodes := Array.mkArray opcodeNames.size 0
+  let mut builtins := Array.mkArray 256 0
+  let mut instructions := 0
+  let mut i := 0
+  while i < codeWords do
+    let insn ← u32
+    let op := insn &&& 0xFF
+    if op ≥ opcodes.size then
+      throw s!"Unknown opcode {op}."
+    opcodes := opcodes.modify op (· + 1)
+    if isFastcall op then
+      builtins := builtins.modify ((insn >>> 8) &&& 0xFF) (· + 1)
+    instructions := instructions + 1
+    i := i + 1
+    if hasAux op then
+      discard u32
+      i := i + 1
+  let constants ← varint
+  for _ in [0:constants] do
+    constant
+  let mut children := #[]
+  for _ in [0:(← varint)] do
+    children := children.push (← varint)
+  let lineDefined ← varint
+  let nameRef ← varint
+  let name := if nameRef == 0 then none else strings[nameRef - 1]?
+  if (← u8) != 0 then
+    let lineGapLog2 ← u8
+    let intervals := ((codeWords - 1) >>> lineGapLog2) + 1
+    skip (codeWords + 4 * intervals)
+  if (← u8) != 0 then
+    for _ in [0:(← varint)] do
+      discard varint
+      discard varint
+      discard varint
+      discard u8
+    for _ in [0:(← varint)] do
+      discard varint
+  pure {
+    name, lineDefined, maxStackSize, numParams, numUpvalues, isVararg,
+    instructions, codeWords, constants, opcodes, builtins, children
+  }
+
+private def chunk : Parser Chunk := do
+  let version ← u8
+  if version == 0 then
+    let c ← get
+    throw <| (String.fromUTF8? (c.data.extract 1 c.data.size)).getD "Compilation failed."
+  if version < 3 || version > 6 then
+    throw s!"Unsupported bytecode version {version}."
+  let typesVersion ← if version ≥ 4 then u8 else pure 0
+  let mut strings := #[]
+  for _ in [0:(← varint)] do
+    strings := strings.push (← string)
+  if typesVersion == 3 then
+    -- Userdata type remapping
+    let mut index ← u8
+    while index != 0 do
+      discard varint
+      index ← u8
+  let mut functions := #[]
+  for _ in [0:(← varint)] do
+    functions := functions.push (← function version strings)
+  let main ← varint
+  pure { version, strings, functions, main }
+
+/-- Parses bytecode. A failed compilation is reported as an error with the compiler's message. -/
+def read (bytes : ByteArray) : Except String Chunk :=
+  (chunk.run' { data := bytes, pos := 0 })
+
+/-- Compiles the source and parses the resulting bytecode. -/
+def compileAndRead (source : String) (options : CompileOptions') : BaseIO (Except String Chunk) := do
+  let ⟨_, bytecode⟩ ← Luau.compile source options
+  pure <| read (copyBytes bytecode.view)
+
+namespace Chunk
+
+def instructions (c : Chunk) : Nat := c.functions.foldl (· + ·.instructions) 0
+
+/-- Functions accessing globals that weren't turned into imports, with the number of accesses. -/
+def globalAccesses (c : Chunk) : Array (String × Nat) :=
+  c.functions.filterMap λ f ↦ if f.globalAccesses > 0 then some (f.label, f.globalAccesses) else none
+
+end Chunk
+
+/-- Totals over a corpus of chunks. -/
+structure Summary where
+  chunks : Nat := 0
+  functions : Nat := 0
+  instructions : Nat := 0
+  codeWords : Nat := 0
+  constants : Nat := 0
+  maxStackSize : Nat := 0
+  globalAccesses : Nat := 0
+  imports : Nat := 0
+  opcodes : Array Nat := Array.mkArray opcodeNames.size 0
+  builtins : Array Nat := Array.mkArray 256 0
+deriving Repr, Inhabited
+
+namespace Summary
+
+private def addArrays (a b : Array Nat) : Array Nat :=
+  a.zipWith b (· + ·)
+
+def addFunction (s : Summary) (f : Function) : Summary := {
+  s with
+  functions := s.functions + 1
+  instructions := s.instructions + f.instructions
+  codeWords := s.codeWords + f.codeWords
+  constants := s.constants + f.constants
+  maxStackSize := max s.maxStackSize f.maxStackSize
+  globalAccesses := s.globalAccesses + f.globalAccesses
+  imports := s.imports + f.imports
+  opcodes := addArrays s.opcodes f.opcodes
+  builtins := addArrays s.builtins f.builtins
+}
+
+def addChunk (s : Summary) (c : Chunk) : Summary :=
+  c.functions.foldl addFunction { s with chunks := s.chunks + 1 }
+
+def ofChunks (chunks : Array Chunk) : Summary :=
+  chunks.foldl addChunk {}
+
+/-- Nonzero opcode counts by name, most frequent first. -/
+def opcodeHistogram (s : Summary) : Array (String × Nat) :=
+  let named := (opcodeNames.zip s.opcodes).filter (·.2 > 0)
+  named.qsort (·.2 > ·.2)
+
+end Summary
+
+/--
+Compiles each source with both option sets and reports the instruction counts of every function
+(matched by name and line; `none` if a function only exists under one option set, e.g. after inlining).
+-/
+def compare (source : String) (a b : CompileOptions') : BaseIO (Except String (Array (String × Option Nat × Option Nat))) := do
+  let ca ← compileAndRead source a
+  let cb ← compileAndRead source b
+  pure do
+    let ca ← ca
+    let cb ← cb
+    let inB (f : Function) := cb.functions.find? λ g ↦ g.name == f.name && g.lineDefined == f.lineDefined
+    let inA (g : Function) := ca.functions.any λ f ↦ g.name == f.name && g.lineDefined == f.lineDefined
+    let fromA := ca.functions.map λ f ↦ (f.label, some f.instructions, (inB f).map (·.instructions))
+    let onlyB := (cb.functions.filter (!inA ·)).map λ g ↦ (g.label, none, some g.instructions)
+    pure (fromA ++ onlyB)
+
+/-- Compiles and summarizes a corpus in parallel. Sources that fail to compile are reported separately. -/
+def summarizeCorpus (sources : Array String) (options : CompileOptions') : BaseIO (Summary × Array (Nat × String)) := do
+  let tasks ← sources.mapM λ source ↦ BaseIO.asTask (compileAndRead source options)
+  let mut summary : Summary := {}
+  let mut errors := #[]
+  for (task, i) in tasks.zipWithIndex do
+    match task.get with
+    | .ok chunk => summary := summary.addChunk chunk
+    | .error e => errors := errors.push (i, e)
+  pure (summary, errors)
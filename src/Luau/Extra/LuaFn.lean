@@ -0,0 +1,130 @@
+import Luau.Lib
+import Luau.Value
+
+/-!
+Host functions with typed arguments and results.
+A plain Lean function such as `Float → String → IO (Float × Bool)` becomes a `CFunction`
+which checks and reads all its arguments with one `State.checkArgs` call
+and pushes all its results with one `State.pushValues` call.
+-/
+
+namespace Luau
+
+/-- Types which can be read from an argument checked by `State.checkArgs`. -/
+class LuaArg (α : Type) where
+  /-- Signature code, see `State.checkArgs`. -/
+  code : String
+  /-- Only called on values matching `code`. -/
+  decode : Value → α
+
+/-- Types which can be returned to Luau. -/
+class LuaResult (α : Type) where
+  encode : α → Array Value → Array Value
+
+instance : LuaArg Number where
+  code := "n"
+  decode
+  | .number n => n
+  | _ => 0
+
+private def floatToInt32 (n : Float) : Int32 :=
+  if n < 0 then Int32.ofInt (-((-n).toUInt32.toNat : Int)) else Int32.ofInt n.toUInt32.toNat
+
+instance : LuaArg Integer where
+  code := "i"
+  decode
+  | .number n => floatToInt32 n
+  | _ => 0
+
+instance : LuaArg Bool where
+  code := "b"
+  decode
+  | .boolean b => b
+  | _ => false
+
+instance : LuaArg String where
+  code := "s"
+  decode
+  | .string s => s
+  | _ => ""
+
+instance : LuaArg ByteArray where
+  code := "B"
+  decode
+  | .buffer b => b
+  | _ => .empty
+
+/-- Tables, functions, userdata and threads are read without a reference, they stay at their argument index. -/
+instance : LuaArg Value where
+  code := "a"
+  decode := id
+
+instance {α : Type} [LuaArg α] : LuaArg (Option α) where
+  code := "?" ++ LuaArg.code α
+  decode
+  | .nil => none
+  | v => some (LuaArg.decode v)
+
+instance : LuaResult Unit where
+  encode _ out := out
+
+instance : LuaResult Number where
+  encode n out := out.push (.number n)
+
+instance : LuaResult Integer where
+  encode n out := out.push (.number (Float.ofInt n.toInt))
+
+instance : LuaResult Bool where
+  encode b out := out.push (.boolean b)
+
+instance : LuaResult String where
+  encode s out := out.push (.string s)
+
+instance : LuaResult ByteArray where
+  encode b out := out.push (.buffer b)
+
+instance : LuaResult Value where
+  encode v out := out.push v
+
+instance {α : Type} [LuaResult α] : LuaResult (Option α) where
+  encode
+  | some a, out => LuaResult.encode a out
+  | none, out => out.push .nil
+
+instance {α β : Type} [LuaResult α] [LuaResult β] : LuaResult (α × β) where
+  encode p out := LuaResult.encode p.2 (LuaResult.encode p.1 out)
+
+/-- Functions `α₁ → ... → αₙ → IO ρ` with `LuaArg` arguments and a `LuaResult` result. -/
+class LuaFn (φ : Type) where
+  signature : String
+  invoke : φ → Array Value → Nat → IO (Array Value)
+
+instance {ρ : Type} [LuaResult ρ] : LuaFn (IO ρ) where
+  signature := ""
+  invoke f _ _ := do pure (LuaResult.encode (← f) #[])
+
+instance {α φ : Type} [LuaArg α] [LuaFn φ] : LuaFn (α → φ) where
+  signature := LuaArg.code α ++ LuaFn.signature φ
+  invoke f args i := LuaFn.invoke (f (LuaArg.decode args[i]!)) args (i + 1)
+
+namespace LuaFn
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/-- Wraps `f` into a `CFunction` doing two FFI calls per invocation, regardless of its arity. -/
+def toCFunction {φ : Type} [LuaFn φ] (f : φ) : CFunction Uu Ut Lt :=
+  let signature := LuaFn.signature φ
+  λ state ↦ do
+    let args ← state.checkArgs signature
+    state.pushValues (← LuaFn.invoke f args 0)
+
+end LuaFn
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+def pushFn {φ : Type} [LuaFn φ] (state : State Uu Ut Lt) (f : φ) (debugName : Option String) : IO Unit :=
+  state.pushCFunction (LuaFn.toCFunction f) debugName
+
+end State
@@ -0,0 +1,474 @@
+import Std.Data.HashMap
+import Std.Data.HashSet
+import Luau.Lib
+import Luau.Compile
+
+open Pod (Buffer)
+
+namespace Luau.Modules
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/-- Code of a module. -/
+inductive Code where
+/-- Source text, compiled on first use. -/
+| text (source : String)
+/-- Precompiled bytecode. -/
+| bytecode (data : ByteArray)
+
+/-- A resolved module. -/
+structure Source where
+  /-- Identifies the module's code in the shared bytecode cache (e.g. its file path) and names its chunk. -/
+  key : String
+  read : IO Code
+  /-- Modification time of the code, `none` if it never changes. -/
+  modified : IO (Option IO.FS.SystemTime) := pure none
+
+/-- Maps module names to their code, returns `none` for unknown modules. -/
+abbrev Resolver := String → IO (Option Source)
+
+/--
+Resolves dot-separated module names to files under `root`,
+e.g. `a.b` to `root/a/b.luau`, trying the extensions in order.
+-/
+def Resolver.directory (root : System.FilePath) (extensions : Array String := #["luau", "lua"]) : Resolver := λ name ↦ do
+  let base := root / name.map (λ c ↦ if c == '.' then System.FilePath.pathSeparator else c)
+  for ext in extensions do
+    let path := base.addExtension ext
+    if ← path.pathExists then
+      return some {
+        key := path.toString
+        read := Code.text <$> IO.FS.readFile path
+        modified := (some ·.modified) <$> path.metadata
+      }
+  return none
+
+/-- Resolves modules from an in-memory list of sources. -/
+def Resolver.ofList (modules : List (String × String)) : Resolver := λ name ↦
+  pure <| (modules.lookup name).map λ code ↦ { key := name, read := pure (.text code) }
+
+/-- Tries `r₁` first, then `r₂`. -/
+def Resolver.orElse (r₁ r₂ : Resolver) : Resolver := λ name ↦ do
+  match ← r₁ name with
+  | some source => pure (some source)
+  | none => r₂ name
+
+/-- Compiled module code, loadable into any state. -/
+inductive Bytecode where
+| compiled {size : Nat} (data : Buffer size 1)
+| precompiled (data : ByteArray)
+
+/-- Loads the bytecode as a function onto the top of the stack. -/
+def Bytecode.load (bytecode : Bytecode) (state : State Uu Ut Lt) (chunkName : String) : IO Unit := do
+  let failed ← match bytecode with
+    | .compiled data => state.load chunkName data.view
+    | .precompiled data => state.load chunkName data.view
+  if failed then
+    let msg := (← state.toString (-1)).getD "Failed to load bytecode."
+    state.pop
+    throw <| IO.userError msg
+
+structure CacheEntry where
+  bytecode : Bytecode
+  modified : Option IO.FS.SystemTime
+
+/-- Bytecode shared by all states of the process. -/
+initialize bytecodeCache : IO.Ref (Std.HashMap String CacheEntry) ← IO.mkRef {}
+
+/-- Registry field holding the table of loaded modules of a state. -/
+def registryField := "_MODULES"
+
+structure Loader where
+  resolve : Resolver
+  options : CompileOptions' := .ofRaw default
+  /-- Separates the shared cache entries of loaders using different compile options. -/
+  cacheScope : String := ""
+
+namespace Loader
+
+def cacheKey (loader : Loader) (source : Source) : String :=
+  if loader.cacheScope.isEmpty then source.key else loader.cacheScope ++ "\x00" ++ source.key
+
+def compile (loader : Loader) (source : Source) (code : Code) (modified : Option IO.FS.SystemTime) : IO Bytecode := do
+  let bytecode ← match code with
+    | .text text => do
+      let ⟨_, data⟩ ← Luau.compile text loader.options
+      pure (Bytecode.compiled data)
+    | .bytecode data => pure (.precompiled data)
+  bytecodeCache.modify (·.insert (loader.cacheKey source) { bytecode, modified })
+  pure bytecode
+
+/-- Returns the cached bytecode of a module if it is up to date. -/
+def cached? (loader : Loader) (source : Source) (modified : Option IO.FS.SystemTime) : IO (Option Bytecode) := do
+  match (← bytecodeCache.get)[loader.cacheKey source]? with
+  | some entry => pure <| if entry.modified == modified then some entry.bytecode else none
+  | none => pure none
+
+/-- Same as `bytecode`, also returning the modification time of the code it was compiled from. -/
+def bytecodeModified (loader : Loader) (source : Source) : IO (Bytecode × Option IO.FS.SystemTime) := do
+  let modified ← source.modified
+  match ← loader.cached? source modified with
+  | some bytecode => pure (bytecode, modified)
+  | none => pure (← loader.compile source (← source.read) modified, modified)
+
+/-- Returns the bytecode of a module, reading and compiling it unless the shared cache is up to date. -/
+def bytecode (loader : Loader) (source : Source) : IO Bytecode :=
+  Prod.fst <$> loader.bytecodeModified source
+
+/-- Pushes the table of loaded modules, creating it if needed. -/
+def pushLoaded (state : State Uu Ut Lt) : IO Unit := do
+  discard <| state.findTable registryIndex registryField 16
+
+/-- Pushes the table marking modules being loaded, which no module can return. -/
+private def pushLoadingMarker (state : State Uu Ut Lt) : IO Unit := do
+  discard <| state.findTable registryIndex (registryField ++ "_LOADING") 0
+
+/-- Whether the value at `idx` marks a module being loaded (see `require`). -/
+def isLoadingMarker (state : State Uu Ut Lt) (idx : Int32) : IO Bool := do
+  let idx ← state.absIndex idx
+  pushLoadingMarker state
+  let res ← state.rawEqual idx (-1)
+  state.pop
+  pure res
+
+private def setLoaded (state : State Uu Ut Lt) (name : String) : IO Unit := do
+  pushLoaded state
+  state.insert (-2)
+  state.rawSetField (-2) name
+  state.pop
+
+/--
+Pushes the result of the module `name`, running the module on first use.
+Results are memoized per state, a module returning nil is recorded as `true`.
+`onLoad` receives the modification time of the code the module is run from.
+-/
+def require (loader : Loader) (state : State Uu Ut Lt) (name : String)
+    (onLoad : Option IO.FS.SystemTime → IO Unit := λ _ ↦ pure ()) : IO Unit := do
+  pushLoaded state
+  let type ← state.rawGetField (-1) name
+  state.remove (-2)
+  if type != .nil then
+    if ← isLoadingMarker state (-1) then
+      state.pop
+      throw <| IO.userError s!"Module '{name}' is required recursively."
+    return
+  state.pop
+  let some source ← loader.resolve name
+    | throw <| IO.userError s!"Module '{name}' not found."
+  -- Marks the module as being loaded
+  pushLoadingMarker state
+  setLoaded state name
+  try
+    let (bytecode, modified) ← loader.bytecodeModified source
+    onLoad modified
+    bytecode.load state ("@" ++ source.key)
+    if (← state.pcall 0 1 0) != 0 then
+      let msg := (← state.toString (-1)).getD s!"Error running module '{name}'."
+      state.pop
+      throw <| IO.userError msg
+  catch e =>
+    state.pushNil
+    setLoaded state name
+    throw e
+  if ← state.isNil (-1) then
+    state.pop
+    state.pushBoolean true
+  state.pushValue (-1)
+  setLoaded state name
+
+/-- Sets the global `require` of the state to load modules through `loader`. -/
+def install (loader : Loader) (state : State Uu Ut Lt)
+    (onLoad : String → Option IO.FS.SystemTime → IO Unit := λ _ _ ↦ pure ()) : IO Unit := do
+  state.pushCFunction (λ s ↦ do
+    let name ← s.checkString 1
+    loader.require s name (onLoad name)
+    pure 1) "require"
+  state.setGlobal "require"
+
+end Loader
+
+private def isIdentStart (c : Char) : Bool := c.isAlpha || c == '_'
+
+private def isIdentChar (c : Char) : Bool := c.isAlphanum || c == '_'
+
+private def skipSpace (s : Array Char) (i : Nat) : Nat := Id.run do
+  let mut j := i
+  while j < s.size && s[j]!.isWhitespace do
+    j := j + 1
+  j
+
+private def skipLine (s : Array Char) (i : Nat) : Nat := Id.run do
+  let mut j := i
+  while j < s.size && s[j]! != '\n' do
+    j := j + 1
+  j
+
+/-- Level of the long bracket (e.g. `[==[`) opening at `i` and the position after it. -/
+private def longBracket? (s : Array Char) (i : Nat) : Option (Nat × Nat) := Id.run do
+  if s[i]? != some '[' then
+    return none
+  let mut j := i + 1
+  while s[j]? == some '=' do
+    j := j + 1
+  if s[j]? == some '[' then some (j - i - 1, j + 1) else none
+
+/-- Position after the long bracket of the given level closing at or after `i`. -/
+private def skipLong (s : Array Char) (i level : Nat) : Nat := Id.run do
+  let mut j := i
+  while j < s.size do
+    if s[j]! == ']' then
+      let mut k := j + 1
+      while s[k]? == some '=' do
+        k := k + 1
+      if k - j - 1 == level && s[k]? == some ']' then
+        return k + 1
+      j := k
+    else
+      j := j + 1
+  s.size
+
+/-- Position after the string closed by `q`, starting at `i` past the opening quote. -/
+private def skipQuoted (s : Array Char) (i : Nat) (q : Char) : Nat := Id.run do
+  let mut j := i
+  while j < s.size do
+    let c := s[j]!
+    if c == '\\' then
+      j := j + 2
+    else if c == q || c == '\n' then
+      return j + 1
+    else
+      j := j + 1
+  s.size
+
+/-- Constant argument of `require "a"` or `require("a")`, `i` being the position past `require`. -/
+private def requireArg? (s : Array Char) (i : Nat) : Option String := Id.run do
+  let mut j := skipSpace s i
+  if s[j]? == some '(' then
+    j := skipSpace s (j + 1)
+  let some q := s[j]?
+    | return none
+  if q != '"' && q != '\'' then
+    return none
+  let mut k := j + 1
+  while k < s.size && s[k]! != q do
+    if s[k]! == '\\' || s[k]! == '\n' then
+      return none
+    k := k + 1
+  if k < s.size then some (String.mk (s.extract (j + 1) k).toList) else none
+
+/--
+Names of the modules required with a constant string, e.g. `require("a.b")`.
+Comments and strings are skipped, as are fields and methods named `require` (`t.require`, `obj:require`).
+-/
+def scanRequires (source : String) : Array String := Id.run do
+  let s := source.toList.toArray
+  let mut names := #[]
+  let mut i := 0
+  -- Last significant character, tells `require` apart from `t.require`
+  let mut prev := ' '
+  while i < s.size do
+    let c := s[i]!
+    if c == '-' && s[i + 1]? == some '-' then
+      match longBracket? s (i + 2) with
+      | some (level, j) => i := skipLong s j level
+      | none => i := skipLine s (i + 2)
+    else if c == '"' || c == '\'' || c == '`' then
+      i := skipQuoted s (i + 1) c
+      prev := c
+    else if let some (level, j) := longBracket? s i then
+      i := skipLong s j level
+      prev := ']'
+    else if isIdentStart c then
+      let mut j := i + 1
+      while j < s.size && isIdentChar s[j]! do
+        j := j + 1
+      if String.mk (s.extract i j).toList == "require" && prev != '.' && prev != ':' then
+        if let some name := requireArg? s j then
+          names := names.push name
+      i := j
+      prev := 'a'
+    else
+      if !c.isWhitespace then
+        prev := c
+      i := i + 1
+  names
+
+namespace Loader
+
+private def preloadOne (loader : Loader) (name : String) : IO (Array String) := do
+  let some source ← loader.resolve name
+    | return #[]
+  let modified ← source.modified
+  let code ← source.read
+  if (← loader.cached? source modified).isNone then
+    discard <| loader.compile source code modified
+  match code with
+  | .text text => pure (scanRequires text)
+  | .bytecode _ => pure #[]
+
+/--
+Compiles in parallel the modules `names` and, transitively, the modules they require (as found by `scanRequires`),
+filling the shared bytecode cache. Unknown modules are skipped, compile errors are reported by `require`.
+-/
+def preload (loader : Loader) (names : Array String) : IO Unit := do
+  let mut seen : Std.HashSet String := {}
+  let mut wave := names
+  while !wave.isEmpty do
+    let mut todo := #[]
+    for name in wave do
+      unless seen.contains name do
+        seen := seen.insert name
+        todo := todo.push name
+    let tasks ← todo.mapM λ name ↦ IO.asTask (loader.preloadOne name)
+    let mut next := #[]
+    for task in tasks do
+      if let .ok deps ← IO.wait task then
+        next := next ++ deps
+    wave := next
+
+end Loader
+
+/-! # Hot reload -/
+
+/-- Outcome of `Reloader.poll`. -/
+structure ReloadReport where
+  /-- Modules whose code changed and was recompiled. -/
+  changed : Array String := #[]
+  /-- Modules that failed to reload, with the error. The previous version stays in place. -/
+  failed : Array (String × String) := #[]
+  /-- Time spent on the reload, in nanoseconds. -/
+  nanos : Nat := 0
+deriving Inhabited
+
+/--
+Keeps the modules of attached states up to date with their code.
+
+Changed modules are recompiled once and rerun in every attached state that has loaded them.
+When both the old and the new result of a module are tables,
+the old table is updated in place so that references to it held elsewhere see the new contents;
+tables of unchanged modules aren't touched.
+-/
+structure Reloader (Uu : Type) (Ut Lt : Tag → Type) where
+  loader : Loader
+  states : IO.Ref (Array (State Uu Ut Lt))
+  /-- For each attached state, modification times of the code its modules were last (re)loaded from. -/
+  modified : IO.Ref (Array (Std.HashMap String (Option IO.FS.SystemTime)))
+
+namespace Reloader
+
+def new (loader : Loader) : IO (Reloader Uu Ut Lt) :=
+  return { loader, states := ← IO.mkRef #[], modified := ← IO.mkRef #[] }
+
+private def record (reloader : Reloader Uu Ut Lt) (i : Nat) (name : String) (modified : Option IO.FS.SystemTime) : IO Unit :=
+  reloader.modified.modify λ all ↦ all.modify i (·.insert name modified)
+
+/-- Installs the loader's `require` in the state and watches the modules it loads. -/
+def attach (reloader : Reloader Uu Ut Lt) (state : State Uu Ut Lt) : IO Unit := do
+  let i ← reloader.states.modifyGet λ states ↦ (states.size, states.push state)
+  reloader.modified.modify (·.push {})
+  reloader.loader.install state (reloader.record i)
+
+/-- Names of the modules loaded by the state. -/
+def loadedNames (state : State Uu Ut Lt) : IO (Array String) := do
+  Loader.pushLoaded state
+  let mut names := #[]
+  let mut iter : Int32 := 0
+  repeat
+    iter ← state.rawIter (-1) iter
+    if iter < 0 then
+      break
+    if ← state.isString (-2) then
+      if let some name ← state.toString (-2) then
+        names := names.push name
+    state.pop 2
+  state.pop
+  pure names
+
+/-- Copies the fields and the metatable of the table at `src` into the table at `dst`, replacing its contents. -/
+private def patchTable (state : State Uu Ut Lt) (dst src : Int32) : IO Unit := do
+  let readonly ← state.getReadonly dst
+  state.setReadonly dst false
+  state.clearTable dst
+  let mut iter : Int32 := 0
+  repeat
+    iter ← state.rawIter src iter
+    if iter < 0 then
+      break
+    state.rawSet dst
+  if ← state.getMetatable src then
+    state.setMetatable dst
+  state.setReadonly dst readonly
+
+/-- Reruns a module in the state and rebinds its result. -/
+private def reloadIn (state : State Uu Ut Lt) (name : String) (source : Source) (bytecode : Bytecode) : IO Unit := do
+  let top ← state.getTop
+  bytecode.load state ("@" ++ source.key)
+  if (← state.pcall 0 1 0) != 0 then
+    let msg := (← state.toString (-1)).getD s!"Error running module '{name}'."
+    state.setTop top
+    throw <| IO.userError msg
+  if ← state.isNil (-1) then
+    state.pop
+    state.pushBoolean true
+  Loader.pushLoaded state
+  discard <| state.rawGetField (-1) name
+  -- Stack: new result, loaded modules, old result
+  if (← state.isTable (top + 1)) && (← state.isTable (top + 3)) then
+    patchTable state (top + 3) (top + 1)
+  else
+    state.pushValue (top + 1)
+    state.rawSetField (top + 2) name
+  state.setTop top
+
+/--
+Recompiles the modules of attached states whose code changed since they were loaded
+and reruns them in the states that use them.
+Each state is compared with the code it actually loaded, modules it didn't load through the installed `require`
+are watched from the first poll.
+Should be called from the thread that runs the states, e.g. between frames or requests.
+-/
+def poll (reloader : Reloader Uu Ut Lt) : IO ReloadReport := do
+  let start ← IO.monoNanosNow
+  let states ← reloader.states.get
+  let mut report : ReloadReport := {}
+  -- Resolved and compiled at most once per poll
+  let mut current : Std.HashMap String (Option (Source × Option IO.FS.SystemTime)) := {}
+  let mut fresh : Std.HashMap String (Option (Bytecode × Option IO.FS.SystemTime)) := {}
+  for (state, i) in states.zipWithIndex do
+    for name in ← loadedNames state do
+      Loader.pushLoaded state
+      let type ← state.rawGetField (-1) name
+      let loaded ← if type == .nil then pure false else not <$> Loader.isLoadingMarker state (-1)
+      state.pop 2
+      if !loaded then
+        continue
+      if !current.contains name then
+        let resolved ← (← reloader.loader.resolve name).mapM λ source ↦ return (source, ← source.modified)
+        current := current.insert name resolved
+      let some (some (source, modified)) := current[name]?
+        | continue
+      match (← reloader.modified.get)[i]?.bind (·[name]?) with
+      | none => reloader.record i name modified
+      | some previous =>
+        if previous == modified then
+          continue
+        if !fresh.contains name then
+          let mut compiled : Option (Bytecode × Option IO.FS.SystemTime) := none
+          try
+            compiled := some (← reloader.loader.bytecodeModified source)
+            report := { report with changed := report.changed.push name }
+          catch e =>
+            report := { report with failed := report.failed.push (name, toString e) }
+          fresh := fresh.insert name compiled
+        match fresh[name]? with
+        | some (some (bytecode, modified')) =>
+          reloader.record i name modified'
+          try
+            reloadIn state name source bytecode
+          catch e =>
+            report := { report with failed := report.failed.push (name, toString e) }
+        -- Reported once, the previous version stays in place
+        | _ => reloader.record i name modified
+  pure { report with nanos := (← IO.monoNanosNow) - start }
+
+end Reloader
@@ -0,0 +1,33 @@
+import Luau.Lib
+
+namespace Luau
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Layout of a plain-data type stored inline in tagged userdata (see `State.newUserdataPod`).
+`toBytes` must produce exactly `byteSize` bytes, and `ofBytes` must accept them.
+Individual fields can be accessed in place with `State.podGet*`/`State.podSet*` at their offsets.
+-/
+class PodUserdata (α : Type) where
+  tag : Tag
+  byteSize : Nat
+  toBytes : α → ByteArray
+  ofBytes : ByteArray → Option α
+
+namespace State
+
+def pushPod {α} [PodUserdata α] (state : State Uu Ut Lt) (x : α) : IO Unit :=
+  state.newUserdataPod (PodUserdata.tag (α := α)) (PodUserdata.toBytes x).view
+
+def toPod {α} [PodUserdata α] (state : State Uu Ut Lt) (idx : Int32) : IO (Option α) := do
+  let some bytes ← state.toUserdataPod idx (PodUserdata.tag (α := α))
+    | pure none
+  if bytes.size == PodUserdata.byteSize (α := α)
+    then pure <| PodUserdata.ofBytes bytes
+    else pure none
+
+def isPod (α) [PodUserdata α] (state : State Uu Ut Lt) (idx : Int32) : IO Bool :=
+  (· == (PodUserdata.tag (α := α)).val.toNat.toInt32) <$> state.userdataTag idx
+
+end State
@@ -0,0 +1,142 @@
+import Luau.Core
+import Luau.Lib
+import Luau.ThreadStats
+
+/-!
+Recycling of coroutine threads: instead of a fresh `newThread` per script invocation,
+threads are reset with `State.recycleThread` and handed out again.
+Released threads get the globals table of the main thread back,
+so globals set up on a thread (e.g. by `State.sandboxThread`) don't leak to the next user.
+-/
+
+namespace Luau
+
+/-- A thread owned by a `ThreadPool`, anchored in the registry of the main state. -/
+structure PooledThread (Uu : Type) (Ut Lt : Tag → Type) where
+  thread : State Uu Ut Lt
+  ref : State.Ref
+  /-- The stack was grown to the pool's `stackSize` and hasn't been shrunk by a reset since. -/
+  grown : Bool := false
+
+structure ThreadPool.Stats where
+  acquired : Nat := 0
+  /-- Acquisitions served by a recycled thread. -/
+  reused : Nat := 0
+  /-- Released threads dropped because the pool was full or the reset failed. -/
+  discarded : Nat := 0
+deriving Inhabited, Repr
+
+def ThreadPool.Stats.reuseRate (s : ThreadPool.Stats) : Float :=
+  if s.acquired == 0 then 0 else s.reused.toFloat / s.acquired.toFloat
+
+structure ThreadPool (Uu : Type) (Ut Lt : Tag → Type) where
+  main : State Uu Ut Lt
+  /-- Maximum number of idle threads kept. -/
+  capacity : Nat
+  /-- Stack slots every handed out thread is grown to, `0` to keep the default. -/
+  stackSize : Int32
+  /-- Handed out threads are sandboxed with `State.sandboxThread`. -/
+  sandbox : Bool
+  idle : IO.Ref (Array (PooledThread Uu Ut Lt))
+  stats : IO.Ref ThreadPool.Stats
+  /-- Accounting counters of released threads (see `State.setThreadAccounting`). -/
+  released : IO.Ref ThreadStats
+
+namespace ThreadPool
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+def new (main : State Uu Ut Lt) (capacity : Nat := 64) (stackSize : Int32 := 0) (sandbox : Bool := false) : IO (ThreadPool Uu Ut Lt) := do
+  pure {
+    main := ← main.mainThread
+    capacity
+    stackSize
+    sandbox
+    idle := ← IO.mkRef (.mkEmpty capacity)
+    stats := ← IO.mkRef {}
+    released := ← IO.mkRef default
+  }
+
+private def create (pool : ThreadPool Uu Ut Lt) : IO (PooledThread Uu Ut Lt) := do
+  let thread ← pool.main.newThread
+  let ref ← pool.main.ref (-1)
+  pool.main.pop 1
+  pure { thread, ref }
+
+/-- Takes an idle thread, or creates one if there is none. -/
+def acquire (pool : ThreadPool Uu Ut Lt) : IO (PooledThread Uu Ut Lt) := do
+  let idle ← pool.idle.modifyGet λ idle ↦ (idle.back?, idle.pop)
+  pool.stats.modify λ s ↦ { s with acquired := s.acquired + 1, reused := s.reused + (if idle.isSome then 1 else 0) }
+  let mut t ← match idle with
+    | some t => pure t
+    | none => pool.create
+  -- Resetting shrinks the stack, threads released in a clean state keep theirs
+  if pool.stackSize > 0 && !t.grown then
+    t := { t with grown := ← t.thread.checkStack pool.stackSize }
+  if pool.sandbox then
+    t.thread.sandboxThread
+  pure t
+
+private def discardThread (pool : ThreadPool Uu Ut Lt) (t : PooledThread Uu Ut Lt) : IO Unit := do
+  pool.main.unref t.ref
+  pool.stats.modify λ s ↦ { s with discarded := s.discarded + 1 }
+
+/--
+Resets the thread and returns it to the pool. The thread must not be used afterwards.
+A thread which finished without error and has no frames left is only cleared, keeping its grown stack.
+-/
+def release (pool : ThreadPool Uu Ut Lt) (t : PooledThread Uu Ut Lt) : IO Unit := do
+  let used ← t.thread.threadStats
+  pool.released.modify (· + used)
+  t.thread.resetThreadStats
+  let mut clean := false
+  try
+    t.thread.setTop 0
+    clean := (← pool.main.coStatus t.thread) == .fin
+    if !clean then
+      t.thread.recycleThread
+    -- `lua_resetthread` keeps the globals table of the thread
+    pool.main.pushValue globalsIndex
+    pool.main.xmove t.thread 1
+    t.thread.replace globalsIndex
+  catch _ =>
+    pool.discardThread t
+    return
+  let t := { t with grown := t.grown && clean }
+  let kept ← pool.idle.modifyGet λ idle ↦
+    if idle.size < pool.capacity then (true, idle.push t) else (false, idle)
+  if !kept then
+    pool.discardThread t
+
+/-- Runs `f` on a pooled thread, releasing it afterwards even if `f` fails. -/
+def withThread {α : Type} (pool : ThreadPool Uu Ut Lt) (f : State Uu Ut Lt → IO α) : IO α := do
+  let t ← pool.acquire
+  try
+    f t.thread
+  finally
+    pool.release t
+
+/-- Creates idle threads until there are `n` of them (at most `capacity`). -/
+def prefill (pool : ThreadPool Uu Ut Lt) (n : Nat := pool.capacity) : IO Unit := do
+  let missing := min n pool.capacity - (← pool.idle.get).size
+  for _ in [0:missing] do
+    let t ← pool.create
+    pool.idle.modify (·.push t)
+
+/-- Drops all idle threads, letting the garbage collector reclaim them. -/
+def clear (pool : ThreadPool Uu Ut Lt) : IO Unit := do
+  let idle ← pool.idle.modifyGet λ idle ↦ (idle, #[])
+  for t in idle do
+    pool.main.unref t.ref
+
+def idleCount (pool : ThreadPool Uu Ut Lt) : IO Nat := do
+  pure (← pool.idle.get).size
+
+def getStats (pool : ThreadPool Uu Ut Lt) : IO ThreadPool.Stats :=
+  pool.stats.get
+
+/-- Resources used by all the threads released to the pool so far. -/
+def usage (pool : ThreadPool Uu Ut Lt) : IO ThreadStats :=
+  pool.released.get
+
+end ThreadPool
@@ -0,0 +1,123 @@
+import Luau.Value
+
+namespace Luau
+
+/-- Representation of a structure field, as laid out by the Lean compiler. -/
+inductive FieldKind where
+| string
+/-- Read as a number, large values lose precision. -/
+| nat
+| value
+/-- Read as a fresh buffer. -/
+| byteArray
+| bool
+| uint8
+| uint16
+| uint32
+| int32
+| uint64
+| float
+| usize
+/-- Hidden boxed field (any other type). -/
+| object
+/-- Hidden unboxed field of the given size in bytes (`UInt8`, `Float`, enumerations, ...). -/
+| scalar (size : Nat)
+/-- Hidden `USize` field. -/
+| hiddenUSize
+deriving Inhabited, BEq, Repr
+
+namespace FieldKind
+
+-- Synchronized with FFI
+def code? : FieldKind → Option UInt32
+| string => some 1
+| nat => some 2
+| value => some 3
+| byteArray => some 4
+| bool => some 5
+| uint8 => some 6
+| uint16 => some 7
+| uint32 => some 8
+| int32 => some 9
+| uint64 => some 10
+| float => some 11
+| usize => some 12
+| _ => none
+
+def isObject : FieldKind → Bool
+| string | nat | value | byteArray | object => true
+| _ => false
+
+def isUSize : FieldKind → Bool
+| usize | hiddenUSize => true
+| _ => false
+
+/-- Size of an unboxed non-`USize` field. -/
+def scalarSize : FieldKind → Nat
+| bool | uint8 => 1
+| uint16 => 2
+| uint32 | int32 => 4
+| uint64 | float => 8
+| scalar size => size
+| _ => 0
+
+end FieldKind
+
+/--
+Field descriptors for `State.registerFieldAccessors`, computed from all the fields of a structure in declaration order:
+boxed fields come first, then `USize` fields, then the other scalars by decreasing size.
+-/
+def fieldDescriptors (fields : Array (String × FieldKind)) : Array (String × UInt32) := Id.run do
+  let ptrSize := System.Platform.numBits / 8
+  let numObjs := (fields.filter (·.2.isObject)).size
+  let numUSize := (fields.filter (·.2.isUSize)).size
+  let mut res := #[]
+  let mut objIdx := 0
+  let mut usizeIdx := numObjs
+  for (name, kind) in fields do
+    if kind.isObject then
+      if let some code := kind.code? then
+        res := res.push (name, (code <<< 24) ||| objIdx.toUInt32)
+      objIdx := objIdx + 1
+    else if kind.isUSize then
+      if let some code := kind.code? then
+        -- `USize` fields are addressed by slot
+        res := res.push (name, (code <<< 24) ||| usizeIdx.toUInt32)
+      usizeIdx := usizeIdx + 1
+  let mut offset := (numObjs + numUSize) * ptrSize
+  for size in [8, 4, 2, 1] do
+    for (name, kind) in fields do
+      if !kind.isObject && !kind.isUSize && kind.scalarSize == size then
+        if let some code := kind.code? then
+          res := res.push (name, (code <<< 24) ||| offset.toUInt32)
+        offset := offset + size
+  res
+
+/--
+Structures whose fields can be read natively from Luau.
+Structures with a single field are represented by that field by the compiler and are not supported.
+-/
+class FieldLayout (α : Type) where
+  /-- All the fields, in declaration order. -/
+  fields : Array (String × FieldKind)
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Sets the metatable of `tag` to read the fields described by `descriptors` (see `fieldDescriptors`)
+straight from the Lean objects of tagged userdata, without calling into Lean.
+Other keys are looked up in the table at index `methods` if it is not `0`.
+Fields are read-only, and the metatable of the tag can't be changed afterwards.
+Descriptors outside of the stored objects, or boxed fields with another representation than their kind,
+read as nil. Unboxed fields are only bounds-checked: prefer `registerFieldLayout`.
+-/
+@[extern "lean_luau_State_registerFieldAccessors"]
+opaque registerFieldAccessors (state : @& State Uu Ut Lt) (tag : Tag) (descriptors : @& Array (String × UInt32)) (methods : Int32 := 0) : IO Unit
+
+/-- Same as `registerFieldAccessors`, with the layout of the objects stored under `tag`. -/
+def registerFieldLayout (state : State Uu Ut Lt) (tag : Tag) [FieldLayout (Ut tag)] (methods : Int32 := 0) : IO Unit :=
+  state.registerFieldAccessors tag (fieldDescriptors (FieldLayout.fields (Ut tag))) methods
+
+end State
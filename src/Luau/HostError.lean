@@ -0,0 +1,56 @@
+import Luau.Value
+
+/-!
+Structured errors raised by host functions.
+A `HostError` reaches scripts as a userdata exposing `code`, `payload` and `message`,
+the message being formatted only when a script converts the error to a string.
+`State.pcallExcept` hands it back to Lean as is.
+-/
+
+namespace Luau
+
+structure HostError where
+  code : UInt32
+  payload : Value := .nil
+  /-- Only evaluated by `tostring(err)` or `err.message` in scripts. -/
+  message : Thunk String := Thunk.mk λ _ ↦ s!"host error {code}"
+deriving Inhabited
+
+/-- Errors returned by `State.pcallExcept`. -/
+inductive CallError where
+/-- Raised by a host function with `State.throwError`, possibly rethrown by scripts. -/
+| host (error : HostError)
+/-- Any other error value, read with `State.toValue`. -/
+| script (status : Status) (value : Value)
+deriving Inhabited
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Remembers `err` as the error carried by the returned `IO.Error`.
+When a `CFunction` fails with that `IO.Error`, `err` is raised without formatting any message.
+-/
+@[extern "lean_luau_State_hostIOError"]
+opaque hostIOError (state : @& State Uu Ut Lt) (err : HostError) : IO IO.Error
+
+/-- Fails the current `CFunction` with a structured error. -/
+def throwError {α : Type} (state : State Uu Ut Lt) (err : HostError) : IO α := do
+  throw (← state.hostIOError err)
+
+@[extern "lean_luau_State_pushHostError"]
+opaque pushHostError (state : @& State Uu Ut Lt) (err : HostError) : IO Unit
+
+@[extern "lean_luau_State_toHostError"]
+opaque toHostError (state : @& State Uu Ut Lt) (idx : Int32) : IO (Option HostError)
+
+/--
+Calls a function like `pcall` (without an error handler) and pops the error value, if any.
+Host errors are returned without being converted to strings.
+`refs` requests references for error values without a Lean counterpart (see `Value`).
+-/
+@[extern "lean_luau_State_pcallExcept"]
+opaque pcallExcept (state : @& State Uu Ut Lt) (nArgs nResults : Int32) (refs : Bool := false) : IO (Except CallError Unit)
+
+end State
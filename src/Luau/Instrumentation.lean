@@ -0,0 +1,62 @@
+import Luau.Initialization
+
+/-!
+Process-wide timing of Lean functions called from Luau.
+Only closures pushed (`pushCClosure`, `pushCClosureK`) while instrumentation is enabled are measured,
+calls are grouped by the closure's debug name.
+-/
+
+namespace Luau.Instrumentation
+
+structure FunctionStats where
+  name : String
+  /-- Non-empty latency buckets as (lower bound in nanoseconds, count), 4 buckets per power of two. -/
+  histogram : Array (UInt64 × UInt64)
+  calls : UInt64
+  /-- Calls which ended with an error, including `unwound` ones. -/
+  errors : UInt64
+  /--
+  Calls left by a Luau error raised inside them (e.g. by `checkString`), which are not timed.
+  They are counted once a later call, or a `pcall` from Lean, observes that they were unwound.
+  -/
+  unwound : UInt64
+  /-- Total time of the calls which returned. -/
+  totalNanos : UInt64
+  maxNanos : UInt64
+deriving Inhabited, Repr
+
+namespace FunctionStats
+
+/-- Number of calls which returned, i.e. were timed. -/
+def timedCalls (s : FunctionStats) : UInt64 :=
+  s.histogram.foldl (λ n (_, count) ↦ n + count) 0
+
+def meanNanos (s : FunctionStats) : Float :=
+  let timed := s.timedCalls
+  if timed == 0 then 0 else s.totalNanos.toFloat / timed.toFloat
+
+/-- Approximate latency (lower bound of the bucket) below which the fraction `q` of timed calls fall. -/
+def quantileNanos (s : FunctionStats) (q : Float) : UInt64 := Id.run do
+  let target := (q * s.timedCalls.toFloat).ceil.toUInt64
+  let mut seen : UInt64 := 0
+  for (lower, count) in s.histogram do
+    seen := seen + count
+    if seen >= target then
+      return lower
+  s.maxNanos
+
+end FunctionStats
+
+@[extern "lean_luau_Instrumentation_setEnabled"]
+opaque setEnabled (enabled : Bool) : BaseIO Unit
+
+def enable : BaseIO Unit := setEnabled true
+def disable : BaseIO Unit := setEnabled false
+
+/-- Zeroes the counters of all functions seen so far. -/
+@[extern "lean_luau_Instrumentation_reset"]
+opaque reset : BaseIO Unit
+
+/-- Current counters of every instrumented function. -/
+@[extern "lean_luau_Instrumentation_snapshot"]
+opaque snapshot : BaseIO (Array FunctionStats)
@@ -2,6 +2,12 @@ import Luau.Core
 
 namespace Luau
 
+open scoped Pod
+open Pod (BytesView)
+
+/-- String builder bound to the state it was created from. -/
+define_foreign_type StrBuf
+
 namespace State
 
 variable {Uu : Type} {Ut Lt : Tag → Type}
@@ -30,6 +36,16 @@ def register' (state : State Uu Ut Lt) (funcs : Array (String × CFunction Uu Ut
     state.pushCFunction f.2 f.1
     state.setField (-2) f.1
 
+/-- Same as `register`, but with native functions which the VM calls directly. -/
+@[extern "lean_luau_State_registerRaw"]
+opaque registerRaw (state : @& State Uu Ut Lt) (libname : @& String) (funcs : @& Array (String × RawCFunction)) : IO Unit
+
+/-- Same as `register'`, but with native functions which the VM calls directly. -/
+def registerRaw' (state : State Uu Ut Lt) (funcs : Array (String × RawCFunction)) : IO Unit := do
+  for f in funcs do
+    state.pushRawCFunction f.2 f.1
+    state.setField (-2) f.1
+
 @[extern "lean_luau_State_getMetaField"]
 opaque getMetaField (state : @& State Uu Ut Lt) (obj : Int32) (event : @& String) : IO Bool
 
@@ -160,7 +176,63 @@ def opt {α : Type} (state : State Uu Ut Lt) (idx : Int32) («def» : α) (f : S
     then pure «def»
     else f state idx
 
--- TODO: Strbuf and fns
+/--
+Creates a string builder (`luaL_Strbuf`).
+Once the content outgrows the builder's inline buffer, its storage is kept on the top of the stack,
+so the stack must be balanced between the builder's operations.
+-/
+@[extern "lean_luau_State_bufInit"]
+opaque bufInit (state : @& State Uu Ut Lt) : IO StrBuf
+
+/-- Same as `bufInit` but preallocates storage for `size` bytes. -/
+@[extern "lean_luau_State_bufInitSize"]
+opaque bufInitSize (state : @& State Uu Ut Lt) (size : USize) : IO StrBuf
+
+/--
+Pushes the concatenation of `chunks` as a single string.
+The result is sized once and no intermediate strings are created.
+-/
+@[extern "lean_luau_State_pushStringFromChunks"]
+opaque pushStringFromChunks (state : @& State Uu Ut Lt) (chunks : @& Array String) : IO Unit
+
+/--
+Parses a JSON document and pushes the resulting value onto the stack.
+Objects and arrays become tables created with their final size, `null` becomes nil.
+-/
+@[extern "lean_luau_State_pushJson"]
+opaque pushJson (state : @& State Uu Ut Lt) {sz : @& Nat} (bytes : @& BytesView sz 1) (maxDepth : UInt32 := 128) : IO Unit
+
+/--
+Encodes the value at index `idx` as JSON.
+Tables whose keys are exactly `1..#t` (including empty tables) become arrays, other tables must have string keys.
+The contents of `out` are replaced, its storage is reused when it isn't shared.
+-/
+@[extern "lean_luau_State_toJson"]
+opaque toJson (state : @& State Uu Ut Lt) (idx : Int32) (out : ByteArray := .empty) (maxDepth : UInt32 := 128) : IO ByteArray
+
+end State
+
+namespace StrBuf
+
+@[extern "lean_luau_StrBuf_addString"]
+opaque addString (buf : @& StrBuf) (s : @& String) : IO Unit
+
+@[extern "lean_luau_StrBuf_addChar"]
+opaque addChar (buf : @& StrBuf) (c : Char) : IO Unit
+
+/-- Pops the value on the top of the stack (a string or a number) and adds it to the buffer. -/
+@[extern "lean_luau_StrBuf_addValue"]
+opaque addValue (buf : @& StrBuf) : IO Unit
+
+/-- Pushes the resulting string. The buffer can't be used afterwards. -/
+@[extern "lean_luau_StrBuf_pushResult"]
+opaque pushResult (buf : @& StrBuf) : IO Unit
+
+end StrBuf
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
 
 def coLibName := "coroutine"
 def tabLibName := "table"
@@ -171,6 +243,7 @@ def bufferLibName := "buffer"
 def utf8LibName := "utf8"
 def mathLibName := "math"
 def dbLibName := "debug"
+def jsonLibName := "json"
 
 @[extern "lean_luau_State_openBase"]
 opaque openBase (state : @& State Uu Ut Lt) : IO Unit
@@ -202,6 +275,10 @@ opaque openMath (state : @& State Uu Ut Lt) : IO Unit
 @[extern "lean_luau_State_openDebug"]
 opaque openDebug (state : @& State Uu Ut Lt) : IO Unit
 
+/-- Opens the `json` library with `json.decode` and `json.encode` implemented natively. Not included in `openLibs`. -/
+@[extern "lean_luau_State_openJson"]
+opaque openJson (state : @& State Uu Ut Lt) : IO Unit
+
 /-- Open all builtin libraries. -/
 @[extern "lean_luau_State_openLibs"]
 opaque openLibs (state : @& State Uu Ut Lt) : IO Unit
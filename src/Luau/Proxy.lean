@@ -0,0 +1,47 @@
+import Std.Data.HashMap
+import Luau.Value
+
+namespace Luau
+
+/--
+A read-only view of Lean data handed to scripts as userdata, without converting it to a table.
+Indexing, `#` and generalized iteration are implemented natively,
+converted record values are cached per proxy.
+-/
+inductive Proxy where
+/-- `p[i]` is `values[i - 1]`. -/
+| array (values : Array Value)
+/-- `p.key` is `lookup key`, `keys` are only computed when the proxy is iterated over. -/
+| record (size : Nat) (keys : Thunk (Array String)) (lookup : String → Option Value)
+
+namespace Proxy
+
+def ofHashMap (m : Std.HashMap String Value) : Proxy :=
+  .record m.size (Thunk.mk λ _ ↦ m.keysArray) m.get?
+
+def ofList (l : List (String × Value)) : Proxy :=
+  ofHashMap (Std.HashMap.ofList l)
+
+end Proxy
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Reserves `tag` for proxies: sets its metatable and destructor.
+The tag must not be used for other userdata, and its metatable can't be changed afterwards.
+Functions typed by `Ut tag` (`newUserdataTagged`, `toUserdataTagged`, `setUserdataDtor`, ...)
+fail for it from then on.
+-/
+@[extern "lean_luau_State_registerProxyTag"]
+opaque registerProxyTag (state : @& State Uu Ut Lt) (tag : Tag) : IO Unit
+
+/--
+Pushes a proxy over `proxy`, which is shared rather than copied.
+`Value.ref` values are pushed from the registry of this state.
+-/
+@[extern "lean_luau_State_pushProxy"]
+opaque pushProxy (state : @& State Uu Ut Lt) (tag : Tag) (proxy : Proxy) : IO Unit
+
+end State
@@ -0,0 +1,51 @@
+import Luau.Core
+
+namespace Luau
+
+/-- Resources used by one thread since accounting was enabled or the counters were reset. -/
+structure ThreadStats where
+  /--
+  Time spent running the thread. Switches made from Lean (`State.resume`, `State.resumeError`)
+  are measured exactly. Switches made by scripts (`coroutine.resume`, `coroutine.wrap`, yields)
+  are only noticed at the next checkpoint, taken every 64 VM interrupts, so the time in between
+  is charged to the thread that was running at the previous checkpoint.
+  Code running under `call`/`pcall` is charged to the calling thread.
+  -/
+  cpuNanos : UInt64
+  allocatedBytes : UInt64
+  allocations : UInt64
+  /-- Resumptions through `State.resume` and `State.resumeError`. -/
+  resumes : UInt64
+deriving Inhabited, Repr
+
+instance : Add ThreadStats where
+  add a b := {
+    cpuNanos := a.cpuNanos + b.cpuNanos
+    allocatedBytes := a.allocatedBytes + b.allocatedBytes
+    allocations := a.allocations + b.allocations
+    resumes := a.resumes + b.resumes
+  }
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Enables per-thread accounting of CPU time and allocations for the whole state.
+Uses the `onallocate`, `interrupt` and `userthread` callbacks and the thread data.
+For live memory per tenant, give each tenant's threads their own memory category (`setMemCat`) and read `totalBytes`.
+-/
+@[extern "lean_luau_State_setThreadAccounting"]
+opaque setThreadAccounting (state : @& State Uu Ut Lt) (enabled : Bool) : IO Unit
+
+/-- Counters of this thread, zero if nothing was recorded for it. -/
+@[extern "lean_luau_State_threadStats"]
+opaque threadStats (state : @& State Uu Ut Lt) : IO ThreadStats
+
+@[extern "lean_luau_State_resetThreadStats"]
+opaque resetThreadStats (state : @& State Uu Ut Lt) : IO Unit
+
+def totalThreadStats (threads : Array (State Uu Ut Lt)) : IO ThreadStats :=
+  threads.foldlM (λ acc t ↦ return acc + (← t.threadStats)) default
+
+end State
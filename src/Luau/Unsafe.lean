@@ -0,0 +1,116 @@
+import Luau.Core
+
+namespace Luau.State.Unsafe
+
+/-!
+Unchecked variants of the hot stack manipulation functions.
+
+They skip the state validity check done by their `State` counterparts and can't fail,
+so they must only be used with states already known to be valid (see `State.isValid`).
+Using a closed or reset state is undefined behavior.
+-/
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+
+/-! # Basic stack manipulation -/
+
+@[extern "lean_luau_State_unsafe_absIndex"]
+opaque absIndex (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Int32
+
+@[extern "lean_luau_State_unsafe_getTop"]
+opaque getTop (state : @& State Uu Ut Lt) : BaseIO Int32
+
+@[extern "lean_luau_State_unsafe_setTop"]
+opaque setTop (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_pop"]
+opaque pop (state : @& State Uu Ut Lt) (n : Int32 := 1) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_pushValue"]
+opaque pushValue (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_remove"]
+opaque remove (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_insert"]
+opaque insert (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_replace"]
+opaque replace (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_checkStack"]
+opaque checkStack (state : @& State Uu Ut Lt) (sz : Int32) : BaseIO Bool
+
+
+/-! # Access functions -/
+
+/-- Returns the raw type code of the value, `tNone` for a non-valid index (see `«Type».toInt32`). -/
+@[extern "lean_luau_State_unsafe_type"]
+opaque type (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Int32
+
+@[extern "lean_luau_State_unsafe_isNil"]
+opaque isNil (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Bool
+
+@[extern "lean_luau_State_unsafe_toNumber"]
+opaque toNumber (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Number
+
+@[extern "lean_luau_State_unsafe_toInteger"]
+opaque toInteger (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Integer
+
+@[extern "lean_luau_State_unsafe_toUnsigned"]
+opaque toUnsigned (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Unsigned
+
+@[extern "lean_luau_State_unsafe_toBoolean"]
+opaque toBoolean (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Bool
+
+
+/-! # Push functions -/
+
+@[extern "lean_luau_State_unsafe_pushNil"]
+opaque pushNil (state : @& State Uu Ut Lt) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_pushNumber"]
+opaque pushNumber (state : @& State Uu Ut Lt) (n : Number) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_pushInteger"]
+opaque pushInteger (state : @& State Uu Ut Lt) (n : Integer) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_pushUnsigned"]
+opaque pushUnsigned (state : @& State Uu Ut Lt) (n : Unsigned) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_pushBoolean"]
+opaque pushBoolean (state : @& State Uu Ut Lt) (b : Bool) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_pushString"]
+opaque pushString (state : @& State Uu Ut Lt) (s : @& String) : BaseIO Unit
+
+
+/-! # Get and set functions -/
+
+@[extern "lean_luau_State_unsafe_rawGet"]
+opaque rawGet (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO «Type»
+
+@[extern "lean_luau_State_unsafe_rawGetI"]
+opaque rawGetI (state : @& State Uu Ut Lt) (idx n : Int32) : BaseIO «Type»
+
+@[extern "lean_luau_State_unsafe_rawGetField"]
+opaque rawGetField (state : @& State Uu Ut Lt) (idx : Int32) (k : @& String) : BaseIO «Type»
+
+@[extern "lean_luau_State_unsafe_rawSet"]
+opaque rawSet (state : @& State Uu Ut Lt) (idx : Int32) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_rawSetI"]
+opaque rawSetI (state : @& State Uu Ut Lt) (idx n : Int32) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_rawSetField"]
+opaque rawSetField (state : @& State Uu Ut Lt) (idx : Int32) (k : @& String) : BaseIO Unit
+
+@[extern "lean_luau_State_unsafe_createTable"]
+opaque createTable (state : @& State Uu Ut Lt) (narr nrec : Int32) : BaseIO Unit
+
+
+/-! # Call functions -/
+
+@[extern "lean_luau_State_unsafe_call"]
+opaque call (state : @& State Uu Ut Lt) (nArgs nResults : Int32) : BaseIO Unit
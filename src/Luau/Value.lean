@@ -0,0 +1,134 @@
+import Luau.Core
+
+namespace Luau
+
+/--
+A Luau value read from the stack in a single call.
+
+Values without a Lean counterpart (tables, functions, userdata, threads, light userdata)
+are represented by their type and, if requested, a registry reference keeping them alive
+(`State.noRef` otherwise). Such references must be released with `State.unref`.
+-/
+inductive Value where
+| nil
+| boolean (b : Bool)
+| number (n : Number)
+| vector (x y z w : Float)
+| string (s : String)
+| buffer (data : ByteArray)
+| ref (type : «Type») (r : State.Ref)
+deriving Inhabited
+
+namespace Value
+
+def type : Value → «Type»
+| nil => .nil
+| boolean _ => .boolean
+| number _ => .number
+| vector .. => .vector
+| string _ => .string
+| buffer _ => .buffer
+| ref type _ => type
+
+def toBool? : Value → Option Bool
+| boolean b => some b
+| _ => none
+
+def toNumber? : Value → Option Number
+| number n => some n
+| _ => none
+
+def toString? : Value → Option String
+| string s => some s
+| _ => none
+
+end Value
+
+namespace State
+
+variable {Uu : Type} {Ut Lt : Tag → Type}
+
+/--
+Reads the value at index `idx`.
+If `refs` is set, values without a Lean counterpart get a registry reference.
+-/
+@[extern "lean_luau_State_toValue"]
+opaque toValue (state : @& State Uu Ut Lt) (idx : Int32) (refs : Bool := false) : IO Value
+
+/-- Pushes a value. `Value.ref` pushes the referenced value, or nil if there is no reference. -/
+@[extern "lean_luau_State_pushValue_2"]
+opaque pushValue' (state : @& State Uu Ut Lt) (value : @& Value) : IO Unit
+
+/-- Returns all key-value pairs of the table at index `idx` (without invoking metamethods). -/
+@[extern "lean_luau_State_rawEntries"]
+opaque rawEntries (state : @& State Uu Ut Lt) (idx : Int32) (refs : Bool := false) : IO (Array (Value × Value))
+
+/--
+Returns at most `max` key-value pairs following the iteration position `iter` (`0` to start)
+and the position to continue from (negative when the iteration is complete).
+-/
+@[extern "lean_luau_State_rawEntriesFrom"]
+opaque rawEntriesFrom (state : @& State Uu Ut Lt) (idx : Int32) (iter : Int32) (max : USize) (refs : Bool := false) : IO (Array (Value × Value) × Int32)
+
+/--
+Folds over the key-value pairs of the table at index `idx`, reading them `chunk` at a time
+(at least one).
+The table must not be modified during the traversal, except for assigning to existing fields.
+-/
+def foldEntries {β : Type} (state : State Uu Ut Lt) (idx : Int32) (init : β) (f : β → Value → Value → IO β)
+    (chunk : USize := 1024) (refs : Bool := false) : IO β := do
+  let idx ← state.absIndex idx
+  let chunk := max chunk 1
+  let mut acc := init
+  let mut iter : Int32 := 0
+  repeat
+    let (entries, next) ← state.rawEntriesFrom idx iter chunk refs
+    for (k, v) in entries do
+      acc ← f acc k v
+    if next < 0 then
+      break
+    iter := next
+  pure acc
+
+/-- Returns the fields of the table at index `idx` with string keys, other keys are skipped. -/
+@[extern "lean_luau_State_rawRecord"]
+opaque rawRecord (state : @& State Uu Ut Lt) (idx : Int32) (refs : Bool := false) : IO (Array (String × Value))
+
+/-- Returns the values `t[1]`, ..., `t[#t]` of the table at index `idx`. -/
+@[extern "lean_luau_State_rawArray"]
+opaque rawArray (state : @& State Uu Ut Lt) (idx : Int32) (refs : Bool := false) : IO (Array Value)
+
+/-- Same as `rawArray` but fails unless all the values are numbers. -/
+@[extern "lean_luau_State_rawNumberArray"]
+opaque rawNumberArray (state : @& State Uu Ut Lt) (idx : Int32) : IO FloatArray
+
+/--
+Checks and reads the arguments of the running function in a single call, according to `signature`:
+`n` number, `i` integer (both accept numeric strings), `b` boolean, `s` string (numbers are converted),
+`B` buffer, `v` vector, `a` any value.
+A code prefixed with `?` also accepts nil or a missing argument, read as `Value.nil`.
+Fails with a "bad argument #k to 'name'" message on the first mismatch, like `luaL_argerror`.
+-/
+@[extern "lean_luau_State_checkArgs"]
+opaque checkArgs (state : @& State Uu Ut Lt) (signature : @& String) : IO (Array Value)
+
+/-- Pushes all the values and returns their number. -/
+@[extern "lean_luau_State_pushValues"]
+opaque pushValues (state : @& State Uu Ut Lt) (values : @& Array Value) : IO Int32
+
+/--
+Calls the function referenced by `fn` (see `ref`) on each input, all in one call.
+Errors are caught per input without aborting the batch.
+Runs on this thread's stack, which is restored after each input.
+-/
+@[extern "lean_luau_State_mapCall"]
+opaque mapCall (state : @& State Uu Ut Lt) (fn : Ref) (inputs : @& Array Value) (refs : Bool := false) : IO (Array (Except String Value))
+
+/--
+Same as `mapCall` for numeric functions. Results are written into `out` when it is not shared and large enough.
+Failed inputs give NaN and are listed with their position and error message.
+-/
+@[extern "lean_luau_State_mapCallNumbers"]
+opaque mapCallNumbers (state : @& State Uu Ut Lt) (fn : Ref) (inputs : @& FloatArray) (out : FloatArray := .empty) : IO (FloatArray × Array (Nat × String))
+
+end State
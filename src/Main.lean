@@ -26,3 +26,9 @@ def main : IO Unit := do
   state.tryLoad "chunky" code.view 0
   state.call 0 1
   IO.println <| ← state.toStringL (-1)
+  -- Lean-backed userdata are shared with copies in unrelated states
+  let other : Luau.State Uu Ut Lt ← Luau.State.new
+  state.newUserdata .a
+  state.copyValue (-1) other
+  IO.println s!"copied userdata: {(← other.toUserdata (-1)).isSome}"
+  other.close